@@ -15,20 +15,50 @@ enum class EnvelopeStage
     Idle     /** Idle stage */
 };
 
+/**
+ * \enum EnvelopeCurve
+ * Shape applied to the envelope's linear segments when it is used.
+ */
+enum class EnvelopeCurve
+{
+    Linear,      /** Level used as-is */
+    Exponential, /** Level cubed, for a more natural-sounding fade */
+    Count
+};
+
+/**
+ * Apply an envelope curve to a linear level.
+ * \tparam Curve Curve to apply.
+ * \param level Linear level (0.0 to 1.0).
+ * \return Shaped level.
+ */
+template <EnvelopeCurve Curve> constexpr float shape_envelope(float const level)
+{
+    if constexpr (Curve == EnvelopeCurve::Exponential)
+        return level * level * level;
+    else
+        return level;
+}
+
 /**
  * \class Envelope
  * Implements an ADSR envelope generator with thread-safe parameters.
  */
 class Envelope
 {
-    std::atomic<uint64_t> m_attackTimeMs;
-    std::atomic<uint64_t> m_decayTimeMs;
-    std::atomic<float>    m_sustainLevel;
-    std::atomic<uint64_t> m_releaseTimeMs;
+    std::atomic<uint64_t>      m_attackTimeMs;
+    std::atomic<uint64_t>      m_decayTimeMs;
+    std::atomic<float>         m_sustainLevel;
+    std::atomic<uint64_t>      m_releaseTimeMs;
+    std::atomic<float>         m_sampleTime{1.0f / constants::audio::sample_rate};
+    std::atomic<EnvelopeCurve> m_curve{EnvelopeCurve::Linear};
+    std::atomic<bool>          m_pendingOn{false};  // applied before Off
+    std::atomic<bool>          m_pendingOff{false};
 
     std::atomic<EnvelopeStage> m_stage{EnvelopeStage::Idle};
     std::atomic<float>         m_stageTime{}; // time spent in current stage
     std::atomic<float>         m_amplitude{};
+    std::atomic<float>         m_releaseLevel{}; // level when release began
 
   public:
     /**
@@ -54,16 +84,32 @@ class Envelope
     void setDecayMs(uint64_t ms);
     void setSustain(float level); // 0.0 to 1.0
     void setReleaseMs(uint64_t ms);
+    void setCurve(EnvelopeCurve curve);
+
+    /**
+     * Set the rate processEnvelope() is called at.
+     * \param sampleRate Samples per second.
+     */
+    void setSampleRate(float sampleRate);
 
-    // Trigger note on/off
+    // Trigger note on/off; applied at the start of the next processed block
     void noteOn();
     void noteOff();
 
     // Process one sample and return amplitude multiplier (0.0 to 1.0)
     float processEnvelope();
 
+    /**
+     * Process a block of samples. Parameters are read once and each stage is
+     * filled with a branch-free loop.
+     * \param out Linear amplitude multipliers (0.0 to 1.0), one per sample.
+     * \param frames Number of samples.
+     */
+    void processBlock(float *out, unsigned long frames);
+
     // Get current state
     [[nodiscard]] float         getCurrentLevel() const;
     [[nodiscard]] EnvelopeStage getCurrentStage() const;
+    [[nodiscard]] EnvelopeCurve getCurve() const;
     [[nodiscard]] bool          isActive() const;
-};
\ No newline at end of file
+};
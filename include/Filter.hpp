@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+
+/**
+ * \class Filter
+ * Stereo state-variable low-pass filter (12 dB/oct, trapezoidal integration).
+ * The cutoff is supplied per block as a start/end pair and ramped linearly,
+ * so it can be modulated at control rate without zipper noise.
+ */
+class Filter
+{
+    std::atomic<bool>  m_enabled;
+    std::atomic<float> m_cutoffHz;
+    std::atomic<float> m_resonance;
+
+    // Integrator state per channel (audio thread only)
+    float m_ic1[2]{};
+    float m_ic2[2]{};
+
+  public:
+    /**
+     * Construct a new Filter object.
+     * \param cutoffHz Base cutoff frequency in Hz.
+     * \param resonance Resonance (0.0 to 1.0).
+     * \param enabled Whether the filter is in the signal path.
+     */
+    explicit Filter(float cutoffHz  = 2000.0f,
+                    float resonance = 0.2f,
+                    bool  enabled   = false);
+
+    // Set filter parameters (thread-safe)
+    void setEnabled(bool enabled);
+    void setCutoffHz(float hz);
+    void setResonance(float resonance); // 0.0 to 1.0
+
+    /**
+     * Filter interleaved stereo frames in place.
+     * \param buffer Interleaved stereo buffer.
+     * \param frames Number of frames.
+     * \param cutoffStartHz Cutoff at the first frame.
+     * \param cutoffEndHz Cutoff after the last frame.
+     * \param sampleRate Sample rate in Hz.
+     */
+    void process(float        *buffer,
+                 unsigned long frames,
+                 float         cutoffStartHz,
+                 float         cutoffEndHz,
+                 float         sampleRate);
+
+    [[nodiscard]] bool  isEnabled() const;
+    [[nodiscard]] float getCutoffHz() const;
+    [[nodiscard]] float getResonance() const;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+
+/**
+ * \enum LfoShape
+ * Waveforms available to a low-frequency oscillator.
+ */
+enum class LfoShape
+{
+    Sine,     /** Sine wave */
+    Triangle, /** Triangle wave */
+    Saw,      /** Rising sawtooth */
+    Square    /** Square wave */
+};
+
+/**
+ * \class Lfo
+ * Low-frequency oscillator producing a bipolar (-1.0 to 1.0) control signal.
+ * Intended to be advanced at control rate rather than per sample.
+ */
+class Lfo
+{
+    std::atomic<float>    m_rateHz;
+    std::atomic<LfoShape> m_shape;
+
+    float m_phase = 0.0f; // audio thread only
+
+  public:
+    /**
+     * Construct a new Lfo object.
+     * \param rateHz Oscillation rate in Hz.
+     * \param shape Waveform.
+     */
+    explicit Lfo(float rateHz = 1.0f, LfoShape shape = LfoShape::Sine);
+
+    // Set LFO parameters (thread-safe)
+    void setRateHz(float hz);
+    void setShape(LfoShape shape);
+
+    /**
+     * Advance the oscillator and return its new value.
+     * \param seconds Time elapsed since the last call.
+     * \return Current value (-1.0 to 1.0).
+     */
+    float advance(float seconds);
+
+    [[nodiscard]] float    getRateHz() const;
+    [[nodiscard]] LfoShape getShape() const;
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+constexpr size_t c_modSlots = 8;
+
+/**
+ * \enum ModSource
+ * Signals that can drive a modulation route.
+ */
+enum class ModSource
+{
+    Lfo1,     /** First LFO (-1.0 to 1.0) */
+    Lfo2,     /** Second LFO (-1.0 to 1.0) */
+    Envelope, /** Modulation envelope (0.0 to 1.0) */
+    Velocity, /** Note velocity (0.0 to 1.0) */
+    KeyTrack, /** Octaves above middle C */
+    Count
+};
+
+/**
+ * \enum ModDestination
+ * Parameters a modulation route can drive.
+ */
+enum class ModDestination
+{
+    Pitch,     /** Semitones */
+    Amplitude, /** Gain offset (added to 1.0) */
+    Cutoff,    /** Filter cutoff in octaves */
+    Pan,       /** Balance (-1.0 left to 1.0 right) */
+    Count
+};
+
+/**
+ * \struct ModTargets
+ * Summed modulation per destination, in the destination's units.
+ */
+struct ModTargets
+{
+    float pitch     = 0.0f;
+    float amplitude = 0.0f;
+    float cutoff    = 0.0f;
+    float pan       = 0.0f;
+};
+
+/**
+ * \class ModMatrix
+ * Fixed set of source-to-destination routes with per-route depth. Routes are
+ * edited from the user thread and evaluated on the audio thread at control
+ * rate.
+ */
+class ModMatrix
+{
+    struct Slot
+    {
+        std::atomic<bool>           enabled{false};
+        std::atomic<ModSource>      source{ModSource::Lfo1};
+        std::atomic<ModDestination> destination{ModDestination::Pitch};
+        std::atomic<float>          amount{0.0f};
+    };
+
+    std::array<Slot, c_modSlots> m_slots;
+
+  public:
+    /**
+     * Set a route (thread-safe).
+     * \param slot Route index (0 to c_modSlots - 1).
+     * \param source Modulation source.
+     * \param destination Modulated parameter.
+     * \param amount Depth in destination units at full-scale source.
+     */
+    void setRoute(size_t         slot,
+                  ModSource      source,
+                  ModDestination destination,
+                  float          amount);
+
+    /**
+     * Disable a route (thread-safe).
+     * \param slot Route index (0 to c_modSlots - 1).
+     */
+    void clearRoute(size_t slot);
+
+    /**
+     * Sum all enabled routes.
+     * \param sources Current source values, indexed by ModSource.
+     * \return Modulation per destination.
+     */
+    [[nodiscard]] ModTargets evaluate(
+        std::array<float, static_cast<size_t>(ModSource::Count)> const
+            &sources) const;
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include "../include/constants.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <portaudio.h>
+#include <vector>
+
+/**
+ * \enum DitherMode
+ * Dither added before quantizing to an integer output format.
+ */
+enum class DitherMode
+{
+    None,       /** Plain rounding */
+    Tpdf,       /** Triangular PDF dither, one LSB peak */
+    NoiseShaped /** TPDF dither with second-order error feedback */
+};
+
+/**
+ * \class OutputConverter
+ *  Converts interleaved stereo float frames to the device's integer sample
+ * format (paInt16, paInt24 or paInt32) with saturation and optional dither,
+ * so PortAudio and the host API do not run a conversion pass of their own.
+ * Owns the float buffer the engine renders into.
+ */
+class OutputConverter
+{
+    static constexpr size_t c_channels = 2;
+
+    PaSampleFormat          m_format;
+    size_t                  m_bytesPerSample;
+    float                   m_scale; // float full scale in LSBs
+    std::atomic<DitherMode> m_dither;
+
+    std::vector<float>   m_buffer; // float frames to convert
+    std::vector<float>   m_noise;  // dither per sample, in LSBs
+    std::vector<int32_t> m_quantized;
+
+    alignas(16) uint32_t m_rngState[2][4];
+
+    // Noise-shaping error history per channel, most recent first
+    float m_error[c_channels][2]{};
+
+    void generateDither(size_t samples);
+    void quantize(size_t samples);
+    void quantizeShaped(size_t frames);
+    void pack(void *out, size_t samples) const;
+
+  public:
+    /**
+     *  Construct a new OutputConverter object.
+     * \param format PortAudio integer sample format.
+     * \param dither Dither mode.
+     * \param maxFrames Largest block convert() will be given.
+     */
+    explicit OutputConverter(
+        PaSampleFormat format,
+        DitherMode     dither    = DitherMode::Tpdf,
+        size_t         maxFrames = constants::audio::frames_per_buffer);
+
+    // Disable copying and moving; the audio thread holds a pointer
+    OutputConverter(OutputConverter const &)            = delete;
+    OutputConverter &operator=(OutputConverter const &) = delete;
+
+    /**
+     *  Set the dither mode (thread-safe).
+     * \param dither New dither mode.
+     */
+    void setDither(DitherMode dither);
+
+    /**
+     *  Get the buffer the engine should render float frames into.
+     * \return Interleaved stereo buffer of getMaxFrames() frames.
+     */
+    [[nodiscard]] float *getBuffer();
+
+    /**
+     *  Convert frames from the float buffer to the device format.
+     * \param out Device buffer.
+     * \param frames Number of frames (at most getMaxFrames()).
+     */
+    void convert(void *out, size_t frames);
+
+    [[nodiscard]] size_t         getMaxFrames() const;
+    [[nodiscard]] size_t         getBytesPerFrame() const;
+    [[nodiscard]] PaSampleFormat getFormat() const;
+    [[nodiscard]] DitherMode     getDither() const;
+};
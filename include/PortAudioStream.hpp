@@ -17,11 +17,13 @@ class PortAudioStream
      * Construct a new PortAudioStream object.
      * \param input_parameters Input stream parameters.
      * \param output_parameters Output stream parameters.
+     * \param sample_rate Device sample rate in Hz.
      * \param callback Pointer to the PortAudio callback function.
      * \param user_data Pointer to user data passed to the callback.
      */
     PortAudioStream(PaStreamParameters const &input_parameters,
                     PaStreamParameters const &output_parameters,
+                    double                    sample_rate,
                     PaStreamCallback         *callback,
                     void                     *user_data);
 
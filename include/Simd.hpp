@@ -0,0 +1,301 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define HPA_SIMD_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HPA_SIMD_NEON 1
+#endif
+
+/**
+ * \namespace simd
+ *  Thin four-lane float wrapper over SSE, NEON or plain scalar code. Kernels
+ * are written once against these helpers and compile to the native vector
+ * instructions of the target.
+ */
+namespace simd
+{
+    constexpr size_t lanes = 4; /** Number of floats per vector. */
+
+#if defined(HPA_SIMD_SSE)
+    using f32x4 = __m128;
+
+    inline f32x4 load(float const *p) { return _mm_loadu_ps(p); }
+    inline void  store(float *p, f32x4 const v) { _mm_storeu_ps(p, v); }
+    inline f32x4 set1(float const x) { return _mm_set1_ps(x); }
+    inline f32x4 add(f32x4 const a, f32x4 const b) { return _mm_add_ps(a, b); }
+    inline f32x4 sub(f32x4 const a, f32x4 const b) { return _mm_sub_ps(a, b); }
+    inline f32x4 mul(f32x4 const a, f32x4 const b) { return _mm_mul_ps(a, b); }
+    inline f32x4 div(f32x4 const a, f32x4 const b) { return _mm_div_ps(a, b); }
+    inline f32x4 fmadd(f32x4 const a, f32x4 const b, f32x4 const c)
+    {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+    inline f32x4 min(f32x4 const a, f32x4 const b) { return _mm_min_ps(a, b); }
+    inline f32x4 max(f32x4 const a, f32x4 const b) { return _mm_max_ps(a, b); }
+    inline f32x4 fract(f32x4 const v) // v >= 0
+    {
+        return _mm_sub_ps(v, _mm_cvtepi32_ps(_mm_cvttps_epi32(v)));
+    }
+    inline void store_int(int32_t *p, f32x4 const v) // truncates
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_cvttps_epi32(v));
+    }
+    inline void store_int_nearest(int32_t *p, f32x4 const v)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_cvtps_epi32(v));
+    }
+
+    using u32x4 = __m128i;
+
+    inline u32x4 load(uint32_t const *p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+    }
+    inline void store(uint32_t *p, u32x4 const v)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+    }
+    inline u32x4 bit_xor(u32x4 const a, u32x4 const b)
+    {
+        return _mm_xor_si128(a, b);
+    }
+    template <int N> u32x4 shift_left(u32x4 const v)
+    {
+        return _mm_slli_epi32(v, N);
+    }
+    template <int N> u32x4 shift_right(u32x4 const v)
+    {
+        return _mm_srli_epi32(v, N);
+    }
+    inline f32x4 to_unit_float(u32x4 const v) // [0, 1)
+    {
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(v, 8)),
+                          _mm_set1_ps(0x1.0p-24f));
+    }
+    inline float hsum(f32x4 const v)
+    {
+        __m128 const shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 const sums = _mm_add_ps(v, shuf);
+        return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuf, sums)));
+    }
+#elif defined(HPA_SIMD_NEON)
+    using f32x4 = float32x4_t;
+
+    inline f32x4 load(float const *p) { return vld1q_f32(p); }
+    inline void  store(float *p, f32x4 const v) { vst1q_f32(p, v); }
+    inline f32x4 set1(float const x) { return vdupq_n_f32(x); }
+    inline f32x4 add(f32x4 const a, f32x4 const b) { return vaddq_f32(a, b); }
+    inline f32x4 sub(f32x4 const a, f32x4 const b) { return vsubq_f32(a, b); }
+    inline f32x4 mul(f32x4 const a, f32x4 const b) { return vmulq_f32(a, b); }
+    inline f32x4 div(f32x4 const a, f32x4 const b) { return vdivq_f32(a, b); }
+    inline f32x4 fmadd(f32x4 const a, f32x4 const b, f32x4 const c)
+    {
+        return vmlaq_f32(c, a, b);
+    }
+    inline f32x4 min(f32x4 const a, f32x4 const b) { return vminq_f32(a, b); }
+    inline f32x4 max(f32x4 const a, f32x4 const b) { return vmaxq_f32(a, b); }
+    inline f32x4 fract(f32x4 const v) // v >= 0
+    {
+        return vsubq_f32(v, vcvtq_f32_s32(vcvtq_s32_f32(v)));
+    }
+    inline void store_int(int32_t *p, f32x4 const v) // truncates
+    {
+        vst1q_s32(p, vcvtq_s32_f32(v));
+    }
+    inline void store_int_nearest(int32_t *p, f32x4 const v)
+    {
+        vst1q_s32(p, vcvtnq_s32_f32(v));
+    }
+
+    using u32x4 = uint32x4_t;
+
+    inline u32x4 load(uint32_t const *p) { return vld1q_u32(p); }
+    inline void  store(uint32_t *p, u32x4 const v) { vst1q_u32(p, v); }
+    inline u32x4 bit_xor(u32x4 const a, u32x4 const b)
+    {
+        return veorq_u32(a, b);
+    }
+    template <int N> u32x4 shift_left(u32x4 const v)
+    {
+        return vshlq_n_u32(v, N);
+    }
+    template <int N> u32x4 shift_right(u32x4 const v)
+    {
+        return vshrq_n_u32(v, N);
+    }
+    inline f32x4 to_unit_float(u32x4 const v) // [0, 1)
+    {
+        return vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(v, 8)), 0x1.0p-24f);
+    }
+    inline float hsum(f32x4 const v) { return vaddvq_f32(v); }
+#else
+    struct f32x4
+    {
+        float v[lanes];
+    };
+
+    inline f32x4 load(float const *p) { return {{p[0], p[1], p[2], p[3]}}; }
+    inline void  store(float *p, f32x4 const v)
+    {
+        for (size_t i = 0; i < lanes; ++i)
+            p[i] = v.v[i];
+    }
+    inline f32x4 set1(float const x) { return {{x, x, x, x}}; }
+    inline f32x4 add(f32x4 const a, f32x4 const b)
+    {
+        return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2],
+                 a.v[3] + b.v[3]}};
+    }
+    inline f32x4 sub(f32x4 const a, f32x4 const b)
+    {
+        return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2],
+                 a.v[3] - b.v[3]}};
+    }
+    inline f32x4 mul(f32x4 const a, f32x4 const b)
+    {
+        return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2],
+                 a.v[3] * b.v[3]}};
+    }
+    inline f32x4 div(f32x4 const a, f32x4 const b)
+    {
+        return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2],
+                 a.v[3] / b.v[3]}};
+    }
+    inline f32x4 fmadd(f32x4 const a, f32x4 const b, f32x4 const c)
+    {
+        return add(mul(a, b), c);
+    }
+    inline f32x4 min(f32x4 const a, f32x4 const b)
+    {
+        f32x4 r;
+        for (size_t i = 0; i < lanes; ++i)
+            r.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i];
+        return r;
+    }
+    inline f32x4 max(f32x4 const a, f32x4 const b)
+    {
+        f32x4 r;
+        for (size_t i = 0; i < lanes; ++i)
+            r.v[i] = a.v[i] < b.v[i] ? b.v[i] : a.v[i];
+        return r;
+    }
+    inline f32x4 fract(f32x4 const v) // v >= 0
+    {
+        f32x4 r;
+        for (size_t i = 0; i < lanes; ++i)
+            r.v[i] = v.v[i] - static_cast<float>(static_cast<int32_t>(v.v[i]));
+        return r;
+    }
+    inline void store_int(int32_t *p, f32x4 const v) // truncates
+    {
+        for (size_t i = 0; i < lanes; ++i)
+            p[i] = static_cast<int32_t>(v.v[i]);
+    }
+    inline void store_int_nearest(int32_t *p, f32x4 const v)
+    {
+        for (size_t i = 0; i < lanes; ++i)
+            p[i] = static_cast<int32_t>(std::lrintf(v.v[i]));
+    }
+
+    struct u32x4
+    {
+        uint32_t v[lanes];
+    };
+
+    inline u32x4 load(uint32_t const *p) { return {{p[0], p[1], p[2], p[3]}}; }
+    inline void  store(uint32_t *p, u32x4 const v)
+    {
+        for (size_t i = 0; i < lanes; ++i)
+            p[i] = v.v[i];
+    }
+    inline u32x4 bit_xor(u32x4 const a, u32x4 const b)
+    {
+        return {{a.v[0] ^ b.v[0], a.v[1] ^ b.v[1], a.v[2] ^ b.v[2],
+                 a.v[3] ^ b.v[3]}};
+    }
+    template <int N> u32x4 shift_left(u32x4 const v)
+    {
+        return {{v.v[0] << N, v.v[1] << N, v.v[2] << N, v.v[3] << N}};
+    }
+    template <int N> u32x4 shift_right(u32x4 const v)
+    {
+        return {{v.v[0] >> N, v.v[1] >> N, v.v[2] >> N, v.v[3] >> N}};
+    }
+    inline f32x4 to_unit_float(u32x4 const v) // [0, 1)
+    {
+        f32x4 r;
+        for (size_t i = 0; i < lanes; ++i)
+            r.v[i] = static_cast<float>(v.v[i] >> 8) * 0x1.0p-24f;
+        return r;
+    }
+    inline float hsum(f32x4 const v)
+    {
+        return v.v[0] + v.v[1] + v.v[2] + v.v[3];
+    }
+#endif
+
+    /**
+     *  Advance a four-lane xorshift32 generator.
+     * \param state Generator state, one seed per lane (must be non-zero).
+     * \return Next random value per lane.
+     */
+    inline u32x4 xorshift(u32x4 &state)
+    {
+        state = bit_xor(state, shift_left<13>(state));
+        state = bit_xor(state, shift_right<17>(state));
+        state = bit_xor(state, shift_left<5>(state));
+        return state;
+    }
+
+    /**
+     *  Dot product of two float arrays.
+     * \param a First array.
+     * \param b Second array.
+     * \param n Element count (must be a multiple of simd::lanes).
+     * \return Sum of a[i] * b[i].
+     */
+    inline float dot(float const *a, float const *b, size_t const n)
+    {
+        f32x4 acc0 = set1(0.0f);
+        f32x4 acc1 = set1(0.0f);
+        size_t i   = 0;
+
+        // Two accumulators hide the add latency on wide cores
+        for (; i + 2 * lanes <= n; i += 2 * lanes)
+        {
+            acc0 = fmadd(load(a + i), load(b + i), acc0);
+            acc1 = fmadd(load(a + i + lanes), load(b + i + lanes), acc1);
+        }
+        for (; i < n; i += lanes)
+            acc0 = fmadd(load(a + i), load(b + i), acc0);
+
+        return hsum(add(acc0, acc1));
+    }
+
+    /**
+     *  Linear blend of two float arrays: out = a + t * (b - a).
+     * \param out Destination array.
+     * \param a Array at t = 0.
+     * \param b Array at t = 1.
+     * \param t Blend position.
+     * \param n Element count (must be a multiple of simd::lanes).
+     */
+    inline void lerp(float       *out,
+                     float const *a,
+                     float const *b,
+                     float const  t,
+                     size_t const n)
+    {
+        f32x4 const vt = set1(t);
+        for (size_t i = 0; i < n; i += lanes)
+        {
+            f32x4 const va = load(a + i);
+            store(out + i, fmadd(sub(load(b + i), va), vt, va));
+        }
+    }
+}
@@ -1,24 +1,37 @@
 #pragma once
 
 #include "../include/Envelope.hpp"
+#include "../include/Filter.hpp"
+#include "../include/Lfo.hpp"
+#include "../include/MidiNote.hpp"
+#include "../include/ModMatrix.hpp"
+#include "../include/OutputFormat.hpp"
+#include "../include/Resampler.hpp"
+#include "../include/Unison.hpp"
+#include "../include/WaveTable.hpp"
 #include <array>
 #include <atomic>
 #include <memory>
 
-constexpr size_t c_tableSize = 1ull << 12; // 4096 (must be power of 2)
-constexpr size_t c_tableMask = c_tableSize - 1;
-
 /**
  * \class StreamState
- *  Holds the state for audio streaming, including phase, frequency,
- * wavetable, and envelope.
+ *  Holds the state for audio streaming, including frequency, wavetable,
+ * unison stack, envelope, filter and modulation.
  */
 class StreamState
 {
     /**
-     *  Current phase of the oscillator (atomic for thread safety).
+     *  Modulated parameters at one control tick, ramped linearly between
+     * ticks.
      */
-    std::atomic<float> m_currentPhase = 0.0f;
+    struct ControlFrame
+    {
+        float phaseInc = 0.0f;
+        float gain     = 1.0f;
+        float cutoffHz = 0.0f;
+        float panL     = 1.0f;
+        float panR     = 1.0f;
+    };
 
     /**
      *  Current frequency in Hz (atomic for thread safety). Modified by
@@ -26,16 +39,120 @@ class StreamState
      */
     std::atomic<float> m_freq;
 
+    /**
+     *  Internal render rate in Hz (atomic for thread safety).
+     */
+    std::atomic<float> m_sampleRate{constants::audio::sample_rate};
+
+    /**
+     *  Velocity of the current note, 0.0 to 1.0 (atomic for thread safety).
+     */
+    std::atomic<float> m_velocity{1.0f};
+
+    /**
+     *  Master output level (atomic for thread safety).
+     */
+    std::atomic<float> m_outputGain{1.0f};
+
+    /**
+     *  Frames between modulation updates (atomic for thread safety).
+     */
+    std::atomic<uint32_t> m_controlPeriod{constants::audio::control_period};
+
+    /**
+     *  Oscillator waveform and wavetable interpolation (atomic for thread
+     * safety). Read once per block to select the render kernel.
+     */
+    std::atomic<Waveform>      m_waveform{Waveform::Sine};
+    std::atomic<Interpolation> m_interpolation{Interpolation::Nearest};
+
     /**
      *  Wavetable for oscillator synthesis.
      */
-    std::array<float, c_tableSize> m_waveTable;
+    WaveTable m_waveTable;
+
+    /**
+     *  Detuned oscillator stack; owns the oscillator phases.
+     */
+    Unison m_unison;
 
     /**
      *  Envelope generator for amplitude shaping.
      */
     Envelope m_envelope;
 
+    /**
+     *  Envelope used as a modulation source, clocked at control rate.
+     */
+    Envelope m_modEnvelope;
+
+    /**
+     *  Low-frequency oscillators used as modulation sources.
+     */
+    std::array<Lfo, 2> m_lfos;
+
+    /**
+     *  Routes from modulation sources to destinations.
+     */
+    ModMatrix m_modMatrix;
+
+    /**
+     *  Low-pass filter applied after the oscillators.
+     */
+    Filter m_filter;
+
+    // Control-rate ramp (audio thread only)
+    ControlFrame m_controlFrom;
+    ControlFrame m_controlTo;
+    uint32_t     m_controlLength    = 0;
+    uint32_t     m_controlRemaining = 0;
+    bool         m_controlPrimed    = false;
+
+    /**
+     *  Converts from the render rate to the device rate, when they differ.
+     */
+    std::unique_ptr<Resampler> m_resampler;
+
+    /**
+     *  Converts to an integer device format; null for paFloat32.
+     */
+    std::unique_ptr<OutputConverter> m_converter;
+
+    void renderOutput(float *out, unsigned long frames);
+    /**
+     *  Renders one control span: oscillators, filter, envelope and mix.
+     */
+    using RenderKernel = void (StreamState::*)(float              *out,
+                                               unsigned long       frames,
+                                               ControlFrame const &from,
+                                               ControlFrame const &to,
+                                               float               sampleRate);
+
+    void         tickControl(float sampleRate);
+    ControlFrame evaluateControl(float seconds, float sampleRate);
+
+    /**
+     *  Render kernel specialized at compile time, so the inner loops carry
+     * no per-sample feature checks.
+     */
+    template <Waveform Wave,
+              Interpolation Interp,
+              EnvelopeCurve Curve,
+              bool          Filtered>
+    void renderKernel(float              *out,
+                      unsigned long       frames,
+                      ControlFrame const &from,
+                      ControlFrame const &to,
+                      float               sampleRate);
+
+    /**
+     *  Look up the kernel instantiation for a set of features.
+     */
+    static RenderKernel selectKernel(Waveform      wave,
+                                     Interpolation interp,
+                                     EnvelopeCurve curve,
+                                     bool          filtered);
+
   public:
     /**
      *  Construct a new StreamState object.
@@ -45,12 +162,6 @@ class StreamState
     explicit StreamState(float           initFreq = 0.0f,
                          Envelope const &env      = Envelope{});
 
-    /**
-     *  Set the oscillator phase.
-     * \param phase New phase value.
-     */
-    void setPhase(float phase);
-
     /**
      *  Set the oscillator frequency.
      * \param frequency New frequency in Hz.
@@ -58,10 +169,72 @@ class StreamState
     void setFrequency(float frequency);
 
     /**
-     *  Get the current oscillator phase.
-     * \return Current phase value.
+     *  Start a note: sets pitch and velocity, retriggers the envelopes and
+     * randomizes unison phases.
+     * \param note MIDI note to play.
+     * \param velocity Note velocity (0.0 to 1.0).
      */
-    [[nodiscard]] float getPhase() const;
+    void noteOn(MidiNote note, float velocity = 1.0f);
+
+    /**
+     *  Release the current note.
+     */
+    void noteOff();
+
+    /**
+     *  Set the master output level, applied after modulation. Use it to
+     * leave headroom for dense patches; the float output is not clipped.
+     * \param gain Linear gain (0.0 or more).
+     */
+    void setOutputGain(float gain);
+
+    /**
+     *  Set how often modulation is evaluated. Values between ticks are
+     * ramped linearly at audio rate.
+     * \param frames Frames per control tick.
+     */
+    void setControlPeriod(uint32_t frames);
+
+    // Set oscillator options (thread-safe)
+    void setWaveform(Waveform waveform);
+    void setInterpolation(Interpolation interpolation);
+
+    /**
+     *  Set the internal render rate. Also retunes the envelope.
+     * \param sampleRate Render rate in Hz.
+     */
+    void setSampleRate(float sampleRate);
+
+    /**
+     *  Match the output to the device rate, adding a resampler stage if the
+     * render rate differs. Not real-time safe; call before the stream starts.
+     * \param deviceRate Device sample rate in Hz.
+     */
+    void setOutputSampleRate(float deviceRate);
+
+    /**
+     *  Set the device sample format, adding an integer conversion stage for
+     * paInt16, paInt24 and paInt32. Not real-time safe; call before the
+     * stream starts.
+     * \param format PortAudio sample format.
+     * \param dither Dither applied when quantizing to integers.
+     */
+    void setOutputFormat(PaSampleFormat format,
+                         DitherMode     dither = DitherMode::Tpdf);
+
+    /**
+     *  Render interleaved stereo frames at the internal rate.
+     * \param out Output buffer.
+     * \param frames Number of frames to render.
+     */
+    void render(float *out, unsigned long frames);
+
+    /**
+     *  Produce interleaved stereo frames at the device rate and format.
+     * \param out Output buffer in the format set by setOutputFormat().
+     * \param frames Number of frames to produce.
+     */
+    void process(void *out, unsigned long frames);
 
     /**
      *  Get the current frequency in Hz.
@@ -69,15 +242,67 @@ class StreamState
      */
     [[nodiscard]] float getCurrentFrequency() const;
 
+    /**
+     *  Get the internal render rate.
+     * \return Render rate in Hz.
+     */
+    [[nodiscard]] float getSampleRate() const;
+
     /**
      *  Get the wavetable used for synthesis.
      * \return Reference to the wavetable array.
      */
-    [[nodiscard]] std::array<float, c_tableSize> const &getWaveTable() const;
+    [[nodiscard]] WaveTable const &getWaveTable() const;
+
+    /**
+     *  Get the unison oscillator stack.
+     * \return Reference to the Unison object.
+     */
+    [[nodiscard]] Unison &getUnison();
 
     /**
      *  Get the envelope generator.
      * \return Reference to the Envelope object.
      */
     [[nodiscard]] Envelope &getEnvelope();
+
+    /**
+     *  Get the modulation envelope.
+     * \return Reference to the modulation Envelope object.
+     */
+    [[nodiscard]] Envelope &getModEnvelope();
+
+    /**
+     *  Get a modulation LFO.
+     * \param index LFO index (0 or 1).
+     * \return Reference to the Lfo object.
+     */
+    [[nodiscard]] Lfo &getLfo(size_t index);
+
+    /**
+     *  Get the modulation matrix.
+     * \return Reference to the ModMatrix object.
+     */
+    [[nodiscard]] ModMatrix &getModMatrix();
+
+    /**
+     *  Get the filter.
+     * \return Reference to the Filter object.
+     */
+    [[nodiscard]] Filter &getFilter();
+
+    /**
+     *  Get the master output level.
+     * \return Linear gain.
+     */
+    [[nodiscard]] float getOutputGain() const;
+
+    /**
+     *  Get the modulation update interval.
+     * \return Frames per control tick.
+     */
+    [[nodiscard]] uint32_t getControlPeriod() const;
+
+    [[nodiscard]] Waveform      getWaveform() const;
+    [[nodiscard]] Interpolation getInterpolation() const;
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+/**
+ * \file Trace.hpp
+ *  Low-overhead trace-event recorder for the audio pipeline. Each thread
+ * writes begin/end spans and counters into its own preallocated ring buffer
+ * with CPU timestamp-counter times; a background thread drains the rings into
+ * a Chrome/Perfetto JSON trace. Build with -DHELLO_PORT_AUDIO_TRACE=ON to
+ * enable; otherwise every macro expands to nothing.
+ */
+
+#if defined(HPA_TRACE_ENABLED)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+namespace trace
+{
+    /**
+     * \enum EventType
+     * Kinds of trace events.
+     */
+    enum class EventType : uint8_t
+    {
+        Begin,  /** Span start */
+        End,    /** Span end */
+        Counter /** Sampled value */
+    };
+
+    /**
+     * \struct Event
+     * One recorded event. The name must be a string literal (it is stored by
+     * pointer and read later by the flush thread).
+     */
+    struct Event
+    {
+        uint64_t    ticks;
+        char const *name;
+        double      value;
+        EventType   type;
+    };
+
+    /**
+     *  Read the CPU timestamp counter, or the steady clock where there is
+     * none.
+     * \return Ticks in an unspecified unit, calibrated by Session.
+     */
+    inline uint64_t now()
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return static_cast<uint64_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    /**
+     *  Record an event on the calling thread's ring. Drops the event if the
+     * ring is full or no ring is free. Wait-free and allocation-free.
+     */
+    void record(EventType type, char const *name, double value = 0.0);
+
+    /**
+     * \class Scope
+     * Emits a begin event on construction and an end event on destruction.
+     */
+    class Scope
+    {
+        char const *m_name;
+
+      public:
+        explicit Scope(char const *name) : m_name(name)
+        {
+            record(EventType::Begin, m_name);
+        }
+
+        Scope(Scope const &)            = delete;
+        Scope &operator=(Scope const &) = delete;
+
+        ~Scope() { record(EventType::End, m_name); }
+    };
+
+    /**
+     * \class Session
+     * Owns the trace file and the background thread that drains the rings
+     * into it. Only one session should exist at a time.
+     */
+    class Session
+    {
+        std::ofstream m_file;
+        std::jthread  m_flushThread;
+        uint64_t      m_startTicks;
+        int64_t       m_startNs;
+        bool          m_firstEvent = true;
+
+        void flush();
+
+      public:
+        /**
+         *  Open the trace file and start the flush thread.
+         * \param path Output path for the JSON trace.
+         */
+        explicit Session(std::string const &path);
+
+        Session(Session const &)            = delete;
+        Session &operator=(Session const &) = delete;
+
+        /**
+         *  Drain the remaining events, close the JSON and stop the thread.
+         */
+        ~Session();
+    };
+}
+
+#define HPA_TRACE_CONCAT_IMPL(a, b) a##b
+#define HPA_TRACE_CONCAT(a, b)      HPA_TRACE_CONCAT_IMPL(a, b)
+
+#define TRACE_SCOPE(name)                                                      \
+    trace::Scope const HPA_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_COUNTER(name, value)                                             \
+    trace::record(trace::EventType::Counter, name, static_cast<double>(value))
+
+#else
+
+#include <string>
+
+namespace trace
+{
+    // Stand-in so callers need no #ifdefs; compiles to nothing
+    class Session
+    {
+      public:
+        explicit Session(std::string const &) {}
+    };
+}
+
+#define TRACE_SCOPE(name)          static_cast<void>(0)
+#define TRACE_COUNTER(name, value) static_cast<void>(0)
+
+#endif
@@ -0,0 +1,221 @@
+#pragma once
+#include "../include/Simd.hpp"
+#include "../include/WaveTable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+constexpr uint32_t c_maxUnisonVoices = 16;
+
+/**
+ * \class Unison
+ *  Stack of detuned, stereo-spread copies of one oscillator. Voice state is
+ * laid out as structure-of-arrays so each group of simd::lanes voices is
+ * processed together. Parameters are set from the user thread; the audio
+ * thread picks up changes at the start of each block.
+ */
+class Unison
+{
+    std::atomic<uint32_t> m_voiceCount;
+    std::atomic<float>    m_detuneCents;
+    std::atomic<float>    m_spread;
+    std::atomic<bool>     m_retrigger{false};
+
+    // Audio thread state, padded to whole vectors. Unused lanes have zero
+    // gain and zero increment.
+    alignas(16) std::array<float, c_maxUnisonVoices> m_phases{};
+    alignas(16) std::array<float, c_maxUnisonVoices> m_ratios{};
+    alignas(16) std::array<float, c_maxUnisonVoices> m_gainL{};
+    alignas(16) std::array<float, c_maxUnisonVoices> m_gainR{};
+
+    uint32_t m_activeLanes = 0; // voices rounded up to simd::lanes
+    uint32_t m_cachedVoices = 0;
+    float    m_cachedDetune = -1.0f;
+    float    m_cachedSpread = -1.0f;
+    uint32_t m_rngState     = 0x9E3779B9u;
+
+    void updateLayout();
+    void randomizePhases();
+    void beginBlock();
+
+    template <Waveform Wave, Interpolation Interp>
+    static simd::f32x4 oscillate(WaveTable const  &table,
+                                 simd::f32x4 const phase,
+                                 simd::f32x4 const inc);
+
+  public:
+    /**
+     *  Construct a new Unison object.
+     * \param voices Number of oscillator copies (1 to c_maxUnisonVoices).
+     * \param detuneCents Detune of the outermost voices in cents.
+     * \param spread Stereo width (0.0 mono to 1.0 hard left/right).
+     */
+    explicit Unison(uint32_t voices      = 1,
+                    float    detuneCents = 0.0f,
+                    float    spread      = 0.0f);
+
+    // Set unison parameters (thread-safe)
+    void setVoices(uint32_t voices);
+    void setDetuneCents(float cents);
+    void setSpread(float spread); // 0.0 to 1.0
+
+    /**
+     *  Request randomized voice phases for the next block. Ignored with a
+     * single voice so a plain oscillator stays phase-continuous.
+     */
+    void noteOn();
+
+    /**
+     *  Render the summed stack as interleaved stereo. The base increment is
+     * ramped linearly across the block.
+     * \tparam Wave Oscillator waveform.
+     * \tparam Interp Wavetable interpolation (sine only).
+     * \param table Wavetable to read from.
+     * \param phaseIncStart Base phase increment (frequency / rate) at the
+     * first frame.
+     * \param phaseIncEnd Base phase increment after the last frame.
+     * \param out Output buffer.
+     * \param frames Number of frames to render.
+     */
+    template <Waveform Wave, Interpolation Interp>
+    void render(WaveTable const &table,
+                float            phaseIncStart,
+                float            phaseIncEnd,
+                float           *out,
+                unsigned long    frames);
+
+    [[nodiscard]] uint32_t getVoices() const;
+    [[nodiscard]] float    getDetuneCents() const;
+    [[nodiscard]] float    getSpread() const;
+};
+
+
+/**
+ *  PolyBLEP residual for a unit step at phase 0, written with min/max so
+ * it compiles without branches. Padding lanes have a zero increment, so it
+ * is floored to keep the result finite.
+ */
+inline simd::f32x4 poly_blep(simd::f32x4 const phase, simd::f32x4 const inc)
+{
+    simd::f32x4 const one = simd::set1(1.0f);
+    simd::f32x4 const dt  = simd::max(inc, simd::set1(1.0e-9f));
+
+    // 1 - rise and 1 + fall, each clamped to [0, 1]
+    simd::f32x4 const rise =
+        simd::max(simd::sub(one, simd::div(phase, dt)), simd::set1(0.0f));
+    simd::f32x4 const fall = simd::max(
+        simd::add(one, simd::div(simd::sub(phase, one), dt)), simd::set1(0.0f));
+
+    return simd::sub(simd::mul(fall, fall), simd::mul(rise, rise));
+}
+
+/**
+ *  Band-limited sawtooth (-1.0 to 1.0) for a vector of phases.
+ */
+inline simd::f32x4 poly_blep_saw(simd::f32x4 const phase,
+                                 simd::f32x4 const inc)
+{
+    simd::f32x4 const naive =
+        simd::fmadd(phase, simd::set1(2.0f), simd::set1(-1.0f));
+    return simd::sub(naive, poly_blep(phase, inc));
+}
+
+/**
+ *  Read the wavetable at four truncated positions.
+ */
+inline void gather(WaveTable const &table,
+                   int32_t const   *index,
+                   int32_t const    offset,
+                   float           *out)
+{
+    for (size_t lane = 0; lane < simd::lanes; ++lane)
+        out[lane] = table[static_cast<size_t>(index[lane] + offset) &
+                          c_tableMask];
+}
+
+template <Waveform Wave, Interpolation Interp>
+simd::f32x4 Unison::oscillate(WaveTable const  &table,
+                              simd::f32x4 const phase,
+                              simd::f32x4 const inc)
+{
+    if constexpr (Wave == Waveform::Saw)
+    {
+        return poly_blep_saw(phase, inc);
+    }
+    else if constexpr (Wave == Waveform::Square)
+    {
+        // A square is the difference of two saws half a cycle apart
+        simd::f32x4 const other =
+            simd::fract(simd::add(phase, simd::set1(0.5f)));
+        return simd::sub(poly_blep_saw(other, inc), poly_blep_saw(phase, inc));
+    }
+    else
+    {
+        // Index math stays in vectors; only the table reads are per lane
+        simd::f32x4 const position =
+            simd::mul(phase, simd::set1(static_cast<float>(c_tableSize)));
+
+        alignas(16) int32_t index[simd::lanes];
+        alignas(16) float   a[simd::lanes];
+        simd::store_int(index, position);
+        gather(table, index, 0, a);
+
+        if constexpr (Interp == Interpolation::Linear)
+        {
+            alignas(16) float b[simd::lanes];
+            gather(table, index, 1, b);
+
+            simd::f32x4 const va = simd::load(a);
+            return simd::fmadd(simd::sub(simd::load(b), va),
+                               simd::fract(position), va);
+        }
+        else
+        {
+            return simd::load(a);
+        }
+    }
+}
+
+template <Waveform Wave, Interpolation Interp>
+void Unison::render(WaveTable const    &table,
+                    float const         phaseIncStart,
+                    float const         phaseIncEnd,
+                    float              *out,
+                    unsigned long const frames)
+{
+    beginBlock();
+
+    std::fill_n(out, frames * 2, 0.0f);
+
+    if (frames == 0)
+        return;
+
+    simd::f32x4 const base = simd::set1(phaseIncStart);
+    simd::f32x4 const step = simd::set1((phaseIncEnd - phaseIncStart) /
+                                        static_cast<float>(frames));
+
+    // One group of lanes at a time so its phases stay in registers
+    for (uint32_t g = 0; g < m_activeLanes; g += simd::lanes)
+    {
+        simd::f32x4 const ratio   = simd::load(m_ratios.data() + g);
+        simd::f32x4       phase   = simd::load(m_phases.data() + g);
+        simd::f32x4       inc     = simd::mul(ratio, base);
+        simd::f32x4 const incStep = simd::mul(ratio, step);
+        simd::f32x4 const gainL   = simd::load(m_gainL.data() + g);
+        simd::f32x4 const gainR   = simd::load(m_gainR.data() + g);
+
+        for (unsigned long i = 0; i < frames; ++i)
+        {
+            simd::f32x4 const sample = oscillate<Wave, Interp>(table, phase, inc);
+            out[2 * i] += simd::hsum(simd::mul(sample, gainL));     // L
+            out[2 * i + 1] += simd::hsum(simd::mul(sample, gainR)); // R
+
+            phase = simd::fract(simd::add(phase, inc));
+            inc   = simd::add(inc, incStep);
+        }
+
+        simd::store(m_phases.data() + g, phase);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <cstddef>
+
+constexpr size_t c_tableSize = 1ull << 12; // 4096 (must be power of 2)
+constexpr size_t c_tableMask = c_tableSize - 1;
+
+/**
+ * \typedef WaveTable
+ *  Single-cycle waveform sampled at c_tableSize points.
+ */
+using WaveTable = std::array<float, c_tableSize>;
+
+/**
+ * \enum Waveform
+ * Oscillator waveform. Sine reads the wavetable; saw and square are computed
+ * directly with PolyBLEP anti-aliasing.
+ */
+enum class Waveform
+{
+    Sine,   /** Wavetable sine */
+    Saw,    /** Band-limited sawtooth */
+    Square, /** Band-limited square */
+    Count
+};
+
+/**
+ * \enum Interpolation
+ * How the wavetable is read between stored points.
+ */
+enum class Interpolation
+{
+    Nearest, /** Truncate to the stored point below */
+    Linear,  /** Blend the two neighbouring points */
+    Count
+};
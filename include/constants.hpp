@@ -10,8 +10,12 @@ namespace constants::audio
 {
     constexpr float standard_A4_hz = 440.0f; /** Standard A4 pitch in Hz. */
     constexpr float sample_rate{44100};      /** Default sample rate. */
+    constexpr float engine_sample_rate{
+        0.0f}; /** Internal render rate; 0 follows the device rate. */
     constexpr unsigned long frames_per_buffer{
         64}; /** Frames per audio buffer. */
+    constexpr uint32_t control_period{
+        16}; /** Frames between modulation updates. */
 }
 
 /**
@@ -1,5 +1,6 @@
 #include "../include/Envelope.hpp"
 #include <algorithm>
+#include <cmath>
 
 Envelope::Envelope(uint64_t const attackMs,
                    uint64_t const decayMs,
@@ -14,9 +15,14 @@ Envelope::Envelope(Envelope const &other)
       m_decayTimeMs(other.m_decayTimeMs.load(std::memory_order_relaxed)),
       m_sustainLevel(other.m_sustainLevel.load(std::memory_order_relaxed)),
       m_releaseTimeMs(other.m_releaseTimeMs.load(std::memory_order_relaxed)),
+      m_sampleTime(other.m_sampleTime.load(std::memory_order_relaxed)),
+      m_curve(other.m_curve.load(std::memory_order_relaxed)),
+      m_pendingOn(other.m_pendingOn.load(std::memory_order_relaxed)),
+      m_pendingOff(other.m_pendingOff.load(std::memory_order_relaxed)),
       m_stage(other.m_stage.load(std::memory_order_relaxed)),
       m_stageTime(other.m_stageTime.load(std::memory_order_relaxed)),
-      m_amplitude(other.m_amplitude.load(std::memory_order_relaxed))
+      m_amplitude(other.m_amplitude.load(std::memory_order_relaxed)),
+      m_releaseLevel(other.m_releaseLevel.load(std::memory_order_relaxed))
 {
 }
 void Envelope::setAttackMs(uint64_t const ms)
@@ -40,132 +46,196 @@ void Envelope::setReleaseMs(uint64_t const ms)
     m_releaseTimeMs.store(ms, std::memory_order_relaxed);
 }
 
+void Envelope::setSampleRate(float const sampleRate)
+{
+    m_sampleTime.store(1.0f / sampleRate, std::memory_order_relaxed);
+}
+
+void Envelope::setCurve(EnvelopeCurve const curve)
+{
+    m_curve.store(curve, std::memory_order_relaxed);
+}
+
 void Envelope::noteOn()
 {
-    m_stage.store(EnvelopeStage::Attack, std::memory_order_relaxed);
-    m_stageTime.store(0.0f, std::memory_order_relaxed);
+    // A later note-on supersedes an earlier, still pending note-off
+    m_pendingOff.store(false, std::memory_order_relaxed);
+    m_pendingOn.store(true, std::memory_order_relaxed);
 }
 
 void Envelope::noteOff()
 {
-    if (m_stage.load(std::memory_order_relaxed) != EnvelopeStage::Idle)
-    {
-        m_stage.store(EnvelopeStage::Release, std::memory_order_relaxed);
-        m_stageTime.store(0.0f, std::memory_order_relaxed);
-    }
+    m_pendingOff.store(true, std::memory_order_relaxed);
 }
 
 float Envelope::processEnvelope()
 {
-    constexpr float sampleTime = 1.0f / constants::audio::sample_rate;
+    float amplitude;
+    processBlock(&amplitude, 1);
+    return amplitude;
+}
+
+namespace
+{
+    // Samples left before stageTime reaches endTime
+    unsigned long samples_until(float const         stageTime,
+                                float const         endTime,
+                                float const         sampleTime,
+                                unsigned long const limit)
+    {
+        if (stageTime >= endTime)
+            return 0;
 
-    EnvelopeStage const stage     = m_stage.load(std::memory_order_relaxed);
-    float const         stageTime = m_stageTime.load(std::memory_order_relaxed);
-    float currentAmplitude;
+        float const remaining = std::ceil((endTime - stageTime) / sampleTime);
+        return remaining >= static_cast<float>(limit)
+                   ? limit
+                   : static_cast<unsigned long>(remaining);
+    }
 
-    switch (stage)
+    // Fill out[0, n) with start + slope * (stageTime + k * sampleTime)
+    void fill_ramp(float              *out,
+                   unsigned long const n,
+                   float const         start,
+                   float const         slope,
+                   float const         stageTime,
+                   float const         sampleTime)
     {
-        case EnvelopeStage::Attack:
-        {
-            float const attackTimeSec = static_cast<float>(m_attackTimeMs.load(
-                                            std::memory_order_relaxed)) /
-                                        1000.0f;
+        for (unsigned long k = 0; k < n; ++k)
+            out[k] = start +
+                     slope * (stageTime + static_cast<float>(k) * sampleTime);
+    }
+}
 
-            // Linear ramp: 0% to 100% over attack time
-            currentAmplitude = stageTime / std::max(attackTimeSec, 0.001f);
+void Envelope::processBlock(float *out, unsigned long const frames)
+{
+    // The audio thread owns the stage; note events are handed over here
+    EnvelopeStage stage        = m_stage.load(std::memory_order_relaxed);
+    float         stageTime    = m_stageTime.load(std::memory_order_relaxed);
+    float         releaseLevel = m_releaseLevel.load(std::memory_order_relaxed);
 
-            // Example: if stageTime = 0.025s and ATTACK_TIME = 0.05s
-            // currentLevel = 0.025 / 0.05 = 0.5 (50% amplitude)
-            if (currentAmplitude >= 1.0f)
-            {
-                // Attack is complete, move to decay
-                // currentLevel = 1.0f; -- reset down to 1.0
-                m_stage.store(EnvelopeStage::Decay, std::memory_order_relaxed);
-                m_stageTime.store(0.0f, std::memory_order_relaxed);
-            }
-            else
-            {
-                // Continue attack, increment time
-                m_stageTime.store(stageTime + sampleTime,
-                                  std::memory_order_relaxed);
-            }
-            break;
-        }
+    // Both flags are queued, so an on/off pair between two blocks still
+    // starts the note before releasing it
+    if (m_pendingOn.exchange(false, std::memory_order_relaxed))
+    {
+        stage     = EnvelopeStage::Attack;
+        stageTime = 0.0f;
+    }
 
-        case EnvelopeStage::Decay:
-        {
-            float const decayTimeSec = static_cast<float>(m_decayTimeMs.load(
-                                           std::memory_order_relaxed)) /
-                                       1000.0f;
-            float const sustainLevel =
-                m_sustainLevel.load(std::memory_order_relaxed);
+    if (m_pendingOff.exchange(false, std::memory_order_relaxed) &&
+        stage != EnvelopeStage::Idle)
+    {
+        // Release linearly from wherever the envelope is now
+        releaseLevel = m_amplitude.load(std::memory_order_relaxed);
+        stage        = EnvelopeStage::Release;
+        stageTime    = 0.0f;
+    }
+
+    float const sampleTime   = m_sampleTime.load(std::memory_order_relaxed);
+    float const sustainLevel = m_sustainLevel.load(std::memory_order_relaxed);
+    auto const  seconds      = [](std::atomic<uint64_t> const &ms)
+    {
+        return static_cast<float>(ms.load(std::memory_order_relaxed)) /
+               1000.0f;
+    };
 
-            // Calculate how much to decay from peak to get to sustain level
-            float const decayAmount =
-                (1.0f - sustainLevel) *
-                (stageTime / std::max(decayTimeSec, 0.001f));
+    float const attackTimeSec  = seconds(m_attackTimeMs);
+    float const decayTimeSec   = seconds(m_decayTimeMs);
+    float const releaseTimeSec = seconds(m_releaseTimeMs);
 
-            currentAmplitude = 1.0f - decayAmount;
+    unsigned long i = 0;
+    while (i < frames)
+    {
+        unsigned long const left = frames - i;
 
-            if (currentAmplitude <= sustainLevel || stageTime >= decayTimeSec)
+        switch (stage)
+        {
+            case EnvelopeStage::Attack:
             {
-                // Delay complete, move to sustain
-                currentAmplitude = sustainLevel;
-                m_stage.store(EnvelopeStage::Sustain,
-                              std::memory_order_relaxed);
-                m_stageTime.store(0.0f, std::memory_order_relaxed);
+                // Linear ramp: 0% to 100% over attack time
+                float const duration = std::max(attackTimeSec, 0.001f);
+                unsigned long const n =
+                    samples_until(stageTime, duration, sampleTime, left);
+
+                fill_ramp(out + i, n, 0.0f, 1.0f / duration, stageTime,
+                          sampleTime);
+                i += n;
+                stageTime += static_cast<float>(n) * sampleTime;
+
+                if (i < frames)
+                {
+                    // Attack is complete, move to decay
+                    out[i++]  = 1.0f;
+                    stage     = EnvelopeStage::Decay;
+                    stageTime = 0.0f;
+                }
+                break;
             }
-            else
+
+            case EnvelopeStage::Decay:
             {
-                m_stageTime.store(stageTime + sampleTime,
-                                  std::memory_order_relaxed);
-            }
-            break;
-        }
+                // Fall from peak to the sustain level over decay time
+                float const duration = std::max(decayTimeSec, 0.001f);
+                unsigned long const n =
+                    samples_until(stageTime, decayTimeSec, sampleTime, left);
 
-        case EnvelopeStage::Sustain:
-        {
-            currentAmplitude = m_sustainLevel.load(std::memory_order_relaxed);
-            // Stay in sustain until noteOff() is called
-            break;
-        }
+                fill_ramp(out + i, n, 1.0f, (sustainLevel - 1.0f) / duration,
+                          stageTime, sampleTime);
+                i += n;
+                stageTime += static_cast<float>(n) * sampleTime;
 
-        case EnvelopeStage::Release:
-        {
-            float const releaseTimeSec =
-                static_cast<float>(
-                    m_releaseTimeMs.load(std::memory_order_relaxed)) /
-                1000.0f;
-
-            // How much amplitude should be reduced
-            float const releaseAmount =
-                currentAmplitude * (stageTime / std::max(releaseTimeSec, 0.001f));
-
-            currentAmplitude = currentAmplitude - releaseAmount;
-    
-            // If amplitude reaches 0 or release time is up, go to idle
-            if (currentAmplitude <= 0.0f || stageTime >= releaseTimeSec)
+                if (i < frames)
+                {
+                    // Decay complete, move to sustain
+                    out[i++]  = sustainLevel;
+                    stage     = EnvelopeStage::Sustain;
+                    stageTime = 0.0f;
+                }
+                break;
+            }
+
+            case EnvelopeStage::Sustain:
             {
-                currentAmplitude = 0.0f;
-                m_stage.store(EnvelopeStage::Idle, std::memory_order_relaxed);
-                m_stageTime.store(0.0f, std::memory_order_relaxed);
+                // Stay in sustain until noteOff() is called
+                std::fill_n(out + i, left, sustainLevel);
+                i = frames;
+                break;
             }
-            else
+
+            case EnvelopeStage::Release:
             {
-                m_stageTime.store(stageTime + sampleTime,
-                                  std::memory_order_relaxed);
+                // Fall from the release level to silence over release time
+                float const duration = std::max(releaseTimeSec, 0.001f);
+                unsigned long const n =
+                    samples_until(stageTime, releaseTimeSec, sampleTime, left);
+
+                fill_ramp(out + i, n, releaseLevel, -releaseLevel / duration,
+                          stageTime, sampleTime);
+                i += n;
+                stageTime += static_cast<float>(n) * sampleTime;
+
+                if (i < frames)
+                {
+                    // Release complete, go to idle
+                    out[i++]  = 0.0f;
+                    stage     = EnvelopeStage::Idle;
+                    stageTime = 0.0f;
+                }
+                break;
             }
-            break;
-        }
 
-        case EnvelopeStage::Idle:
-        default:
-            currentAmplitude = 0.0f;
-            break;
+            case EnvelopeStage::Idle:
+            default:
+                std::fill_n(out + i, left, 0.0f);
+                i = frames;
+                break;
+        }
     }
 
-    m_amplitude.store(currentAmplitude, std::memory_order_relaxed);
-    return currentAmplitude;
+    m_stage.store(stage, std::memory_order_relaxed);
+    m_stageTime.store(stageTime, std::memory_order_relaxed);
+    m_releaseLevel.store(releaseLevel, std::memory_order_relaxed);
+    if (frames > 0)
+        m_amplitude.store(out[frames - 1], std::memory_order_relaxed);
 }
 
 float Envelope::getCurrentLevel() const
@@ -173,6 +243,11 @@ float Envelope::getCurrentLevel() const
     return m_amplitude.load(std::memory_order_relaxed);
 }
 
+EnvelopeCurve Envelope::getCurve() const
+{
+    return m_curve.load(std::memory_order_relaxed);
+}
+
 EnvelopeStage Envelope::getCurrentStage() const
 {
     return m_stage.load(std::memory_order_relaxed);
@@ -180,5 +255,6 @@ EnvelopeStage Envelope::getCurrentStage() const
 
 bool Envelope::isActive() const
 {
-    return m_stage.load(std::memory_order_relaxed) != EnvelopeStage::Idle;
+    return m_stage.load(std::memory_order_relaxed) != EnvelopeStage::Idle ||
+           m_pendingOn.load(std::memory_order_relaxed);
 }
\ No newline at end of file
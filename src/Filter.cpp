@@ -0,0 +1,88 @@
+#include "../include/Filter.hpp"
+#include "../include/constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Filter::Filter(float const cutoffHz, float const resonance, bool const enabled)
+    : m_enabled(enabled), m_cutoffHz(std::max(cutoffHz, 1.0f)),
+      m_resonance(std::clamp(resonance, 0.0f, 1.0f))
+{
+}
+
+void Filter::setEnabled(bool const enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Filter::setCutoffHz(float const hz)
+{
+    m_cutoffHz.store(std::max(hz, 1.0f), std::memory_order_relaxed);
+}
+
+void Filter::setResonance(float const resonance)
+{
+    m_resonance.store(std::clamp(resonance, 0.0f, 1.0f),
+                      std::memory_order_relaxed);
+}
+
+bool Filter::isEnabled() const
+{
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+float Filter::getCutoffHz() const
+{
+    return m_cutoffHz.load(std::memory_order_relaxed);
+}
+
+float Filter::getResonance() const
+{
+    return m_resonance.load(std::memory_order_relaxed);
+}
+
+void Filter::process(float              *buffer,
+                     unsigned long const frames,
+                     float const         cutoffStartHz,
+                     float const         cutoffEndHz,
+                     float const         sampleRate)
+{
+    if (frames == 0)
+        return;
+
+    // Keep the cutoff below Nyquist so tan() stays finite
+    auto const warp = [sampleRate](float const hz)
+    {
+        float const limited = std::clamp(hz, 1.0f, 0.49f * sampleRate);
+        return std::tan(std::numbers::pi_v<float> * limited / sampleRate);
+    };
+
+    // Damping: 2.0 is no resonance, approaching 0.0 self-oscillates
+    float const k = 2.0f - 1.9f * getResonance();
+
+    // Ramp the warped cutoff; the tan() is only paid twice per block
+    float       g     = warp(cutoffStartHz);
+    float const gStep = (warp(cutoffEndHz) - g) / static_cast<float>(frames);
+
+    for (unsigned long i = 0; i < frames; ++i)
+    {
+        float const a1 = 1.0f / (1.0f + g * (g + k));
+        float const a2 = g * a1;
+        float const a3 = g * a2;
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            float const v0 = buffer[2 * i + ch];
+            float const v3 = v0 - m_ic2[ch];
+            float const v1 = a1 * m_ic1[ch] + a2 * v3;
+            float const v2 = m_ic2[ch] + a2 * m_ic1[ch] + a3 * v3;
+
+            m_ic1[ch] = 2.0f * v1 - m_ic1[ch];
+            m_ic2[ch] = 2.0f * v2 - m_ic2[ch];
+
+            buffer[2 * i + ch] = v2; // low-pass output
+        }
+
+        g += gStep;
+    }
+}
@@ -0,0 +1,49 @@
+#include "../include/Lfo.hpp"
+#include "../include/constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Lfo::Lfo(float const rateHz, LfoShape const shape)
+    : m_rateHz(std::max(rateHz, 0.0f)), m_shape(shape)
+{
+}
+
+void Lfo::setRateHz(float const hz)
+{
+    m_rateHz.store(std::max(hz, 0.0f), std::memory_order_relaxed);
+}
+
+void Lfo::setShape(LfoShape const shape)
+{
+    m_shape.store(shape, std::memory_order_relaxed);
+}
+
+float Lfo::getRateHz() const { return m_rateHz.load(std::memory_order_relaxed); }
+
+LfoShape Lfo::getShape() const
+{
+    return m_shape.load(std::memory_order_relaxed);
+}
+
+float Lfo::advance(float const seconds)
+{
+    m_phase += getRateHz() * seconds;
+    m_phase -= std::floor(m_phase);
+
+    switch (getShape())
+    {
+        case LfoShape::Sine:
+            return std::sin(m_phase * constants::math::tau);
+
+        case LfoShape::Triangle:
+            return 1.0f - 4.0f * std::abs(m_phase - 0.5f);
+
+        case LfoShape::Saw:
+            return 2.0f * m_phase - 1.0f;
+
+        case LfoShape::Square:
+        default:
+            return m_phase < 0.5f ? 1.0f : -1.0f;
+    }
+}
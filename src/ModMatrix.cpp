@@ -0,0 +1,54 @@
+#include "../include/ModMatrix.hpp"
+
+#include <stdexcept>
+
+void ModMatrix::setRoute(size_t const         slot,
+                         ModSource const      source,
+                         ModDestination const destination,
+                         float const          amount)
+{
+    if (slot >= c_modSlots)
+        throw std::out_of_range("Modulation slot out of range.");
+
+    Slot &s = m_slots[slot];
+    s.enabled.store(false, std::memory_order_relaxed);
+    s.source.store(source, std::memory_order_relaxed);
+    s.destination.store(destination, std::memory_order_relaxed);
+    s.amount.store(amount, std::memory_order_relaxed);
+    s.enabled.store(true, std::memory_order_release);
+}
+
+void ModMatrix::clearRoute(size_t const slot)
+{
+    if (slot >= c_modSlots)
+        throw std::out_of_range("Modulation slot out of range.");
+
+    m_slots[slot].enabled.store(false, std::memory_order_relaxed);
+}
+
+ModTargets ModMatrix::evaluate(
+    std::array<float, static_cast<size_t>(ModSource::Count)> const &sources)
+    const
+{
+    std::array<float, static_cast<size_t>(ModDestination::Count)> sums{};
+
+    for (Slot const &s : m_slots)
+    {
+        if (!s.enabled.load(std::memory_order_acquire))
+            continue;
+
+        auto const src = static_cast<size_t>(
+            s.source.load(std::memory_order_relaxed));
+        auto const dst = static_cast<size_t>(
+            s.destination.load(std::memory_order_relaxed));
+
+        sums[dst] += sources[src] * s.amount.load(std::memory_order_relaxed);
+    }
+
+    return {
+        .pitch     = sums[static_cast<size_t>(ModDestination::Pitch)],
+        .amplitude = sums[static_cast<size_t>(ModDestination::Amplitude)],
+        .cutoff    = sums[static_cast<size_t>(ModDestination::Cutoff)],
+        .pan       = sums[static_cast<size_t>(ModDestination::Pan)],
+    };
+}
@@ -0,0 +1,189 @@
+#include "../include/OutputFormat.hpp"
+#include "../include/Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+OutputConverter::OutputConverter(PaSampleFormat const format,
+                                 DitherMode const     dither,
+                                 size_t const         maxFrames)
+    : m_format(format), m_dither(dither),
+      m_rngState{{0x9E3779B9u, 0x85EBCA6Bu, 0xC2B2AE35u, 0x27D4EB2Fu},
+                 {0x165667B1u, 0xD3A2646Cu, 0xFD7046C5u, 0xB55A4F09u}}
+{
+    switch (format)
+    {
+        case paInt16:
+            m_bytesPerSample = 2;
+            m_scale          = 0x1.0p15f;
+            break;
+
+        case paInt24:
+            m_bytesPerSample = 3;
+            m_scale          = 0x1.0p23f;
+            break;
+
+        case paInt32:
+            m_bytesPerSample = 4;
+            m_scale          = 0x1.0p31f;
+            break;
+
+        default:
+            throw std::invalid_argument("Unsupported output sample format.");
+    }
+
+    // Pad to whole vectors so the SIMD loops need no scalar tail
+    size_t const samples =
+        (std::max<size_t>(maxFrames, 1) * c_channels + simd::lanes - 1) &
+        ~(simd::lanes - 1);
+
+    m_buffer.assign(samples, 0.0f);
+    m_noise.assign(samples, 0.0f);
+    m_quantized.assign(samples, 0);
+}
+
+void OutputConverter::setDither(DitherMode const dither)
+{
+    m_dither.store(dither, std::memory_order_relaxed);
+}
+
+DitherMode OutputConverter::getDither() const
+{
+    return m_dither.load(std::memory_order_relaxed);
+}
+
+PaSampleFormat OutputConverter::getFormat() const { return m_format; }
+
+float *OutputConverter::getBuffer() { return m_buffer.data(); }
+
+size_t OutputConverter::getMaxFrames() const
+{
+    return m_buffer.size() / c_channels;
+}
+
+size_t OutputConverter::getBytesPerFrame() const
+{
+    return m_bytesPerSample * c_channels;
+}
+
+void OutputConverter::generateDither(size_t const samples)
+{
+    simd::u32x4 stateA = simd::load(m_rngState[0]);
+    simd::u32x4 stateB = simd::load(m_rngState[1]);
+
+    // Difference of two uniforms: triangular over (-1, 1) LSB
+    for (size_t i = 0; i < samples; i += simd::lanes)
+    {
+        simd::f32x4 const a = simd::to_unit_float(simd::xorshift(stateA));
+        simd::f32x4 const b = simd::to_unit_float(simd::xorshift(stateB));
+        simd::store(m_noise.data() + i, simd::sub(a, b));
+    }
+
+    simd::store(m_rngState[0], stateA);
+    simd::store(m_rngState[1], stateB);
+}
+
+void OutputConverter::quantize(size_t const samples)
+{
+    // Largest float that still fits; for 32-bit this sits just below 2^31
+    float const high = std::min(m_scale - 1.0f, std::nextafter(m_scale, 0.0f));
+
+    simd::f32x4 const scale = simd::set1(m_scale);
+    simd::f32x4 const lo    = simd::set1(-m_scale);
+    simd::f32x4 const hi    = simd::set1(high);
+
+    for (size_t i = 0; i < samples; i += simd::lanes)
+    {
+        simd::f32x4 const v = simd::fmadd(simd::load(m_buffer.data() + i),
+                                          scale, simd::load(m_noise.data() + i));
+        simd::store_int_nearest(m_quantized.data() + i,
+                                simd::min(simd::max(v, lo), hi));
+    }
+}
+
+void OutputConverter::quantizeShaped(size_t const frames)
+{
+    float const high = std::min(m_scale - 1.0f, std::nextafter(m_scale, 0.0f));
+
+    // Error feedback filter (1 - z^-1)^2 pushes the requantization noise
+    // towards Nyquist, where it is least audible
+    for (size_t i = 0; i < frames; ++i)
+    {
+        for (size_t ch = 0; ch < c_channels; ++ch)
+        {
+            size_t const s = i * c_channels + ch;
+            float       *e = m_error[ch];
+            float const  v = m_buffer[s] * m_scale - (2.0f * e[0] - e[1]);
+            float const  q =
+                std::clamp(std::nearbyint(v + m_noise[s]), -m_scale, high);
+
+            // Bound the fed-back error so clipping cannot make it run away
+            e[1] = e[0];
+            e[0] = std::clamp(q - v, -2.0f, 2.0f);
+
+            m_quantized[s] = static_cast<int32_t>(q);
+        }
+    }
+}
+
+void OutputConverter::pack(void *out, size_t const samples) const
+{
+    switch (m_format)
+    {
+        case paInt16:
+        {
+            auto *dst = static_cast<int16_t *>(out);
+            for (size_t i = 0; i < samples; ++i)
+                dst[i] = static_cast<int16_t>(m_quantized[i]);
+            break;
+        }
+
+        case paInt24:
+        {
+            // Packed little-endian, three bytes per sample
+            auto *dst = static_cast<uint8_t *>(out);
+            for (size_t i = 0; i < samples; ++i)
+            {
+                auto const v = static_cast<uint32_t>(m_quantized[i]);
+                dst[3 * i]     = static_cast<uint8_t>(v);
+                dst[3 * i + 1] = static_cast<uint8_t>(v >> 8);
+                dst[3 * i + 2] = static_cast<uint8_t>(v >> 16);
+            }
+            break;
+        }
+
+        case paInt32:
+        default:
+            std::memcpy(out, m_quantized.data(), samples * sizeof(int32_t));
+            break;
+    }
+}
+
+void OutputConverter::convert(void *out, size_t const frames)
+{
+    size_t const samples = frames * c_channels;
+    size_t const padded  = (samples + simd::lanes - 1) & ~(simd::lanes - 1);
+
+    switch (getDither())
+    {
+        case DitherMode::None:
+            std::fill_n(m_noise.data(), padded, 0.0f);
+            quantize(padded);
+            break;
+
+        case DitherMode::Tpdf:
+            generateDither(padded);
+            quantize(padded);
+            break;
+
+        case DitherMode::NoiseShaped:
+        default:
+            generateDither(padded);
+            quantizeShaped(frames);
+            break;
+    }
+
+    pack(out, samples);
+}
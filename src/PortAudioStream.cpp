@@ -4,11 +4,12 @@
 
 PortAudioStream::PortAudioStream(PaStreamParameters const &input_parameters,
                                  PaStreamParameters const &output_parameters,
+                                 double const              sample_rate,
                                  PaStreamCallback         *callback,
                                  void                     *user_data)
 {
     PaError const err = Pa_OpenStream(
-        &m_paStream, nullptr, &output_parameters, constants::audio::sample_rate,
+        &m_paStream, nullptr, &output_parameters, sample_rate,
         constants::audio::frames_per_buffer, paClipOff, callback, user_data);
 
     if (err != paNoError)
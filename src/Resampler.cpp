@@ -0,0 +1,100 @@
+#include "../include/Resampler.hpp"
+#include "../include/constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+    // Zeroth-order modified Bessel function of the first kind (power series)
+    double bessel_i0(double const x)
+    {
+        double sum  = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 32; ++k)
+        {
+            double const half = x / (2.0 * k);
+            term *= half * half;
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double kaiser_beta = 8.0; /** Sidelobes near -80 dB. */
+
+    // Kaiser's estimate of the transition width the window gives for a
+    // length, as a fraction of Nyquist
+    double transition_width(size_t const taps)
+    {
+        double const attenuation = kaiser_beta / 0.1102 + 8.7;
+        return (attenuation - 8.0) /
+               (2.285 * static_cast<double>(taps - 1) * std::numbers::pi);
+    }
+}
+
+Resampler::Resampler(double const inputRate,
+                     double const outputRate,
+                     size_t const taps,
+                     size_t const phases,
+                     size_t const blockFrames)
+    : m_ratio(inputRate / outputRate),
+      m_taps((std::max<size_t>(static_cast<size_t>(std::ceil(
+                                   static_cast<double>(taps) *
+                                   std::max(1.0, inputRate / outputRate))),
+                               simd::lanes) +
+              simd::lanes - 1) &
+             ~(simd::lanes - 1)),
+      m_phases(std::max<size_t>(phases, 1)),
+      m_blockFrames(std::max<size_t>(blockFrames, 1))
+{
+    if (!(inputRate > 0.0) || !(outputRate > 0.0))
+    {
+        throw std::invalid_argument("Resampler rates must be positive.");
+    }
+
+    // Put the stopband edge at the lower of the two Nyquist frequencies, so
+    // nothing above the output Nyquist aliases back when decimating
+    double const stopband = std::min(1.0, outputRate / inputRate);
+    double const cutoff   = stopband - transition_width(m_taps) / 2.0;
+    double const centre = static_cast<double>(m_taps) / 2.0 - 1.0;
+    double const half   = static_cast<double>(m_taps) / 2.0;
+    double const norm   = bessel_i0(kaiser_beta);
+
+    m_kernel.resize((m_phases + 1) * m_taps);
+    for (size_t row = 0; row <= m_phases; ++row)
+    {
+        double const offset =
+            static_cast<double>(row) / static_cast<double>(m_phases);
+        float *coeffs = m_kernel.data() + row * m_taps;
+
+        for (size_t tap = 0; tap < m_taps; ++tap)
+        {
+            double const d    = static_cast<double>(tap) - centre - offset;
+            double const x    = std::numbers::pi * cutoff * d;
+            double const sinc = d == 0.0 ? 1.0 : std::sin(x) / x;
+            double const w    = std::clamp(d / half, -1.0, 1.0);
+            double const window =
+                bessel_i0(kaiser_beta * std::sqrt(1.0 - w * w)) / norm;
+            coeffs[tap] = static_cast<float>(sinc * window);
+        }
+
+        // Unity gain at DC for every phase
+        float const sum = std::accumulate(coeffs, coeffs + m_taps, 0.0f);
+        std::transform(coeffs, coeffs + m_taps, coeffs,
+                       [sum](float const c) { return c / sum; });
+    }
+
+    m_frameKernel.resize(m_taps);
+    for (auto &history : m_history)
+        history.assign(m_taps + m_blockFrames, 0.0f);
+    m_scratch.resize(m_blockFrames * c_channels);
+
+    // Start with a window of silence so the first output is centred
+    m_fill = m_taps - 1;
+}
+
+double Resampler::getRatio() const { return m_ratio; }
+
+size_t Resampler::getLatencyFrames() const { return m_taps / 2; }
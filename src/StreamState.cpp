@@ -1,16 +1,19 @@
 #include "../include/StreamState.hpp"
 #include "../include/Envelope.hpp"
+#include "../include/Trace.hpp"
 #include "../include/constants.hpp"
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <utility>
 
 StreamState::StreamState(float const initFreq, Envelope const &env)
     : m_freq(initFreq),
       m_waveTable(
           []
           {
-              std::array<float, c_tableSize> t{};
+              WaveTable t{};
 
               for (size_t i = 0; i < c_tableSize; ++i)
               {
@@ -22,19 +25,21 @@ StreamState::StreamState(float const initFreq, Envelope const &env)
           }()),
       m_envelope(env)
 {
+    m_modEnvelope.setSampleRate(getSampleRate() /
+                                static_cast<float>(getControlPeriod()));
 }
 
 Envelope &StreamState::getEnvelope() { return m_envelope; }
 
-float StreamState::getPhase() const
-{
-    return m_currentPhase.load(std::memory_order_relaxed);
-}
+Unison &StreamState::getUnison() { return m_unison; }
 
-void StreamState::setPhase(float const phase)
-{
-    m_currentPhase.store(phase, std::memory_order_relaxed);
-}
+Envelope &StreamState::getModEnvelope() { return m_modEnvelope; }
+
+Lfo &StreamState::getLfo(size_t const index) { return m_lfos.at(index); }
+
+ModMatrix &StreamState::getModMatrix() { return m_modMatrix; }
+
+Filter &StreamState::getFilter() { return m_filter; }
 
 float StreamState::getCurrentFrequency() const
 {
@@ -46,7 +51,329 @@ void StreamState::setFrequency(float const frequency)
     m_freq.store(frequency, std::memory_order_relaxed);
 }
 
-std::array<float, c_tableSize> const &StreamState::getWaveTable() const
+float StreamState::getSampleRate() const
+{
+    return m_sampleRate.load(std::memory_order_relaxed);
+}
+
+void StreamState::setSampleRate(float const sampleRate)
+{
+    m_sampleRate.store(sampleRate, std::memory_order_relaxed);
+    m_envelope.setSampleRate(sampleRate);
+    m_modEnvelope.setSampleRate(sampleRate /
+                                static_cast<float>(getControlPeriod()));
+}
+
+float StreamState::getOutputGain() const
+{
+    return m_outputGain.load(std::memory_order_relaxed);
+}
+
+void StreamState::setOutputGain(float const gain)
+{
+    m_outputGain.store(std::max(gain, 0.0f), std::memory_order_relaxed);
+}
+
+uint32_t StreamState::getControlPeriod() const
+{
+    return m_controlPeriod.load(std::memory_order_relaxed);
+}
+
+void StreamState::setControlPeriod(uint32_t const frames)
+{
+    uint32_t const period = std::max(frames, 1u);
+    m_controlPeriod.store(period, std::memory_order_relaxed);
+    m_modEnvelope.setSampleRate(getSampleRate() / static_cast<float>(period));
+}
+
+void StreamState::setWaveform(Waveform const waveform)
+{
+    m_waveform.store(waveform, std::memory_order_relaxed);
+}
+
+void StreamState::setInterpolation(Interpolation const interpolation)
+{
+    m_interpolation.store(interpolation, std::memory_order_relaxed);
+}
+
+Waveform StreamState::getWaveform() const
+{
+    return m_waveform.load(std::memory_order_relaxed);
+}
+
+Interpolation StreamState::getInterpolation() const
+{
+    return m_interpolation.load(std::memory_order_relaxed);
+}
+
+void StreamState::setOutputFormat(PaSampleFormat const format,
+                                  DitherMode const     dither)
+{
+    if (format == paFloat32)
+    {
+        m_converter.reset();
+        return;
+    }
+
+    m_converter = std::make_unique<OutputConverter>(format, dither);
+}
+
+void StreamState::noteOn(MidiNote const note, float const velocity)
+{
+    setFrequency(midi_to_frequency(note));
+    m_velocity.store(std::clamp(velocity, 0.0f, 1.0f),
+                     std::memory_order_relaxed);
+
+    m_unison.noteOn();
+    m_modEnvelope.noteOn();
+    m_envelope.noteOn();
+}
+
+void StreamState::noteOff()
+{
+    m_modEnvelope.noteOff();
+    m_envelope.noteOff();
+}
+
+void StreamState::setOutputSampleRate(float const deviceRate)
+{
+    float const renderRate = getSampleRate();
+    if (renderRate == deviceRate)
+    {
+        m_resampler.reset();
+        return;
+    }
+
+    m_resampler = std::make_unique<Resampler>(renderRate, deviceRate);
+}
+
+WaveTable const &StreamState::getWaveTable() const
 {
     return m_waveTable;
-}
\ No newline at end of file
+}
+
+StreamState::ControlFrame StreamState::evaluateControl(float const seconds,
+                                                       float const sampleRate)
+{
+    float const freq = getCurrentFrequency();
+
+    std::array<float, static_cast<size_t>(ModSource::Count)> sources{};
+    sources[static_cast<size_t>(ModSource::Lfo1)] = m_lfos[0].advance(seconds);
+    sources[static_cast<size_t>(ModSource::Lfo2)] = m_lfos[1].advance(seconds);
+    sources[static_cast<size_t>(ModSource::Envelope)] =
+        m_modEnvelope.getCurve() == EnvelopeCurve::Exponential
+            ? shape_envelope<EnvelopeCurve::Exponential>(
+                  m_modEnvelope.processEnvelope())
+            : m_modEnvelope.processEnvelope();
+    sources[static_cast<size_t>(ModSource::Velocity)] =
+        m_velocity.load(std::memory_order_relaxed);
+    sources[static_cast<size_t>(ModSource::KeyTrack)] =
+        freq > 0.0f ? std::log2(freq / midi_to_frequency(MidiNote::C4)) : 0.0f;
+
+    ModTargets const mod = m_modMatrix.evaluate(sources);
+
+    // Balance law: unity at the centre, and moving off-centre only fades
+    // the far channel, so neither gain exceeds 1.0
+    float const pan    = std::clamp(mod.pan, -1.0f, 1.0f);
+    float const halfPi = 0.5f * std::numbers::pi_v<float>;
+
+    return {
+        .phaseInc = freq * std::exp2(mod.pitch / 12.0f) / sampleRate,
+        .gain     = std::max(1.0f + mod.amplitude, 0.0f) * getOutputGain(),
+        .cutoffHz = m_filter.getCutoffHz() * std::exp2(mod.cutoff),
+        .panL     = std::cos(std::max(pan, 0.0f) * halfPi),
+        .panR     = std::cos(std::max(-pan, 0.0f) * halfPi),
+    };
+}
+
+void StreamState::tickControl(float const sampleRate)
+{
+    TRACE_SCOPE("control");
+
+    uint32_t const     period = std::max(getControlPeriod(), 1u);
+    ControlFrame const next   = evaluateControl(
+        static_cast<float>(period) / sampleRate, sampleRate);
+
+    // Ramp from where the previous tick ended; jump on the very first tick
+    m_controlFrom      = m_controlPrimed ? m_controlTo : next;
+    m_controlTo        = next;
+    m_controlPrimed    = true;
+    m_controlLength    = period;
+    m_controlRemaining = period;
+}
+
+template <Waveform Wave,
+          Interpolation Interp,
+          EnvelopeCurve Curve,
+          bool          Filtered>
+void StreamState::renderKernel(float              *out,
+                               unsigned long const frames,
+                               ControlFrame const &from,
+                               ControlFrame const &to,
+                               float const         sampleRate)
+{
+    {
+        TRACE_SCOPE("unison");
+        m_unison.render<Wave, Interp>(m_waveTable, from.phaseInc, to.phaseInc,
+                                      out, frames);
+    }
+
+    if constexpr (Filtered)
+    {
+        TRACE_SCOPE("filter");
+        m_filter.process(out, frames, from.cutoffHz, to.cutoffHz, sampleRate);
+    }
+
+    TRACE_SCOPE("envelope");
+
+    float const step  = 1.0f / static_cast<float>(frames);
+    float const dGain = (to.gain - from.gain) * step;
+    float const dPanL = (to.panL - from.panL) * step;
+    float const dPanR = (to.panR - from.panR) * step;
+
+    float gain = from.gain;
+    float panL = from.panL;
+    float panR = from.panR;
+
+    // Apply envelope, modulated gain and balance to the oscillator output,
+    // a fixed-size chunk of envelope at a time
+    constexpr unsigned long chunk = 64;
+    alignas(16) float       envelope[chunk];
+
+    for (unsigned long start = 0; start < frames; start += chunk)
+    {
+        unsigned long const n = std::min(chunk, frames - start);
+        m_envelope.processBlock(envelope, n);
+
+        for (unsigned long i = 0; i < n; ++i)
+        {
+            float const level = shape_envelope<Curve>(envelope[i]) * gain;
+
+            *out++ *= level * panL; // L
+            *out++ *= level * panR; // R
+
+            gain += dGain;
+            panL += dPanL;
+            panR += dPanR;
+        }
+    }
+}
+
+StreamState::RenderKernel StreamState::selectKernel(
+    Waveform const      wave,
+    Interpolation const interp,
+    EnvelopeCurve const curve,
+    bool const          filtered)
+{
+    constexpr auto waves   = static_cast<size_t>(Waveform::Count);
+    constexpr auto interps = static_cast<size_t>(Interpolation::Count);
+    constexpr auto curves  = static_cast<size_t>(EnvelopeCurve::Count);
+
+    // Every feature combination, indexed as [wave][interp][curve][filtered]
+    static constexpr auto table = []<size_t... Is>(std::index_sequence<Is...>)
+    {
+        return std::array<RenderKernel, sizeof...(Is)>{
+            &StreamState::renderKernel<
+                static_cast<Waveform>(Is / (interps * curves * 2)),
+                static_cast<Interpolation>(Is / (curves * 2) % interps),
+                static_cast<EnvelopeCurve>(Is / 2 % curves), Is % 2 == 1>...};
+    }(std::make_index_sequence<waves * interps * curves * 2>{});
+
+    size_t const index = ((static_cast<size_t>(wave) * interps +
+                           static_cast<size_t>(interp)) *
+                              curves +
+                          static_cast<size_t>(curve)) *
+                             2 +
+                         (filtered ? 1 : 0);
+
+    return table[index];
+}
+
+void StreamState::render(float *out, unsigned long frames)
+{
+    float const sampleRate = getSampleRate();
+
+    // Pick the specialized kernel once for the whole block
+    RenderKernel const kernel =
+        selectKernel(getWaveform(), getInterpolation(), m_envelope.getCurve(),
+                     m_filter.isEnabled());
+
+    // Split the block at control ticks; each span ramps between the values
+    // interpolated at its ends
+    while (frames > 0)
+    {
+        if (m_controlRemaining == 0)
+            tickControl(sampleRate);
+
+        unsigned long const n =
+            std::min<unsigned long>(frames, m_controlRemaining);
+
+        float const length = static_cast<float>(m_controlLength);
+        float const t0 =
+            1.0f - static_cast<float>(m_controlRemaining) / length;
+        float const t1 =
+            1.0f - static_cast<float>(m_controlRemaining - n) / length;
+
+        auto const at = [this](float const t)
+        {
+            auto const mix = [t](float const a, float const b)
+            { return a + (b - a) * t; };
+
+            return ControlFrame{
+                .phaseInc = mix(m_controlFrom.phaseInc, m_controlTo.phaseInc),
+                .gain     = mix(m_controlFrom.gain, m_controlTo.gain),
+                .cutoffHz = mix(m_controlFrom.cutoffHz, m_controlTo.cutoffHz),
+                .panL     = mix(m_controlFrom.panL, m_controlTo.panL),
+                .panR     = mix(m_controlFrom.panR, m_controlTo.panR),
+            };
+        };
+
+        (this->*kernel)(out, n, at(t0), at(t1), sampleRate);
+
+        out += 2 * n;
+        frames -= n;
+        m_controlRemaining -= static_cast<uint32_t>(n);
+    }
+}
+
+void StreamState::renderOutput(float *out, unsigned long const frames)
+{
+    if (m_resampler)
+    {
+        TRACE_SCOPE("resample");
+        m_resampler->process(out, frames,
+                             [this](float *buffer, unsigned long const n)
+                             { render(buffer, n); });
+        return;
+    }
+
+    render(out, frames);
+}
+
+void StreamState::process(void *out, unsigned long frames)
+{
+    if (!m_converter)
+    {
+        renderOutput(static_cast<float *>(out), frames);
+        return;
+    }
+
+    // Render into the converter's float buffer, then write the device format
+    auto        *dst      = static_cast<std::byte *>(out);
+    size_t const capacity = m_converter->getMaxFrames();
+
+    while (frames > 0)
+    {
+        auto const n = static_cast<unsigned long>(
+            std::min<size_t>(frames, capacity));
+
+        renderOutput(m_converter->getBuffer(), n);
+        {
+            TRACE_SCOPE("output");
+            m_converter->convert(dst, n);
+        }
+
+        dst += n * m_converter->getBytesPerFrame();
+        frames -= n;
+    }
+}
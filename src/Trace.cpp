@@ -0,0 +1,164 @@
+#include "../include/Trace.hpp"
+
+#if defined(HPA_TRACE_ENABLED)
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    constexpr size_t c_ringSize   = 1ull << 14; // events (power of 2)
+    constexpr size_t c_ringMask   = c_ringSize - 1;
+    constexpr size_t c_maxThreads = 8;
+
+    constexpr auto c_flushInterval = std::chrono::milliseconds(50);
+
+    /**
+     * \struct Ring
+     *  Single-producer single-consumer event ring owned by one thread.
+     */
+    struct Ring
+    {
+        std::array<trace::Event, c_ringSize> events;
+        std::atomic<size_t>                  head{0}; // written by producer
+        std::atomic<size_t>                  tail{0}; // written by consumer
+        std::atomic<uint64_t>                dropped{0};
+    };
+
+    // Preallocated so the first event on the audio thread never allocates
+    std::array<Ring, c_maxThreads> g_rings;
+    std::atomic<size_t>            g_ringCount{0};
+
+    thread_local Ring *t_ring       = nullptr;
+    thread_local bool  t_registered = false;
+
+    int64_t steady_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+}
+
+void trace::record(EventType const type, char const *name, double const value)
+{
+    if (!t_registered)
+    {
+        t_registered = true;
+        if (size_t const slot = g_ringCount.fetch_add(1); slot < c_maxThreads)
+            t_ring = &g_rings[slot];
+    }
+
+    Ring *ring = t_ring;
+    if (ring == nullptr)
+        return;
+
+    size_t const head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= c_ringSize)
+    {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring->events[head & c_ringMask] = {now(), name, value, type};
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+trace::Session::Session(std::string const &path)
+    : m_file(path), m_startTicks(now()), m_startNs(steady_ns())
+{
+    if (!m_file)
+    {
+        throw std::runtime_error("Could not open trace file " + path);
+    }
+
+    m_file << "{\"traceEvents\":[\n";
+
+    m_flushThread = std::jthread(
+        [this](std::stop_token const &stop)
+        {
+            while (!stop.stop_requested())
+            {
+                std::this_thread::sleep_for(c_flushInterval);
+                flush();
+            }
+        });
+}
+
+void trace::Session::flush()
+{
+    // Calibrate against the steady clock over the whole session so far
+    uint64_t const ticks   = now() - m_startTicks;
+    int64_t const  elapsed = steady_ns() - m_startNs;
+    double const   usPerTick =
+        ticks > 0 ? static_cast<double>(elapsed) / 1000.0 /
+                        static_cast<double>(ticks)
+                  : 0.0;
+
+    size_t const rings = std::min(g_ringCount.load(), c_maxThreads);
+    for (size_t tid = 0; tid < rings; ++tid)
+    {
+        Ring        &ring = g_rings[tid];
+        size_t const head = ring.head.load(std::memory_order_acquire);
+        size_t       tail = ring.tail.load(std::memory_order_relaxed);
+
+        for (; tail != head; ++tail)
+        {
+            Event const &e = ring.events[tail & c_ringMask];
+            double const ts =
+                static_cast<double>(e.ticks - m_startTicks) * usPerTick;
+
+            char line[256];
+            switch (e.type)
+            {
+                case EventType::Begin:
+                case EventType::End:
+                    std::snprintf(
+                        line, sizeof(line),
+                        R"({"name":"%s","ph":"%c","ts":%.3f,"pid":1,"tid":%zu})",
+                        e.name, e.type == EventType::Begin ? 'B' : 'E', ts,
+                        tid);
+                    break;
+
+                case EventType::Counter:
+                default:
+                    std::snprintf(
+                        line, sizeof(line),
+                        R"({"name":"%s","ph":"C","ts":%.3f,"pid":1,"tid":%zu,"args":{"value":%g}})",
+                        e.name, ts, tid, e.value);
+                    break;
+            }
+
+            m_file << (m_firstEvent ? "" : ",\n") << line;
+            m_firstEvent = false;
+        }
+
+        ring.tail.store(tail, std::memory_order_release);
+    }
+
+    m_file.flush();
+}
+
+trace::Session::~Session()
+{
+    m_flushThread.request_stop();
+    if (m_flushThread.joinable())
+        m_flushThread.join();
+
+    flush();
+
+    for (size_t tid = 0; tid < std::min(g_ringCount.load(), c_maxThreads);
+         ++tid)
+    {
+        if (uint64_t const dropped = g_rings[tid].dropped.load())
+            std::fprintf(stderr, "trace: thread %zu dropped %llu events\n",
+                         tid, static_cast<unsigned long long>(dropped));
+    }
+
+    m_file << "\n]}\n";
+}
+
+#endif
@@ -0,0 +1,119 @@
+#include "../include/Unison.hpp"
+#include "../include/Simd.hpp"
+#include "../include/constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Unison::Unison(uint32_t const voices,
+               float const    detuneCents,
+               float const    spread)
+    : m_voiceCount(std::clamp(voices, 1u, c_maxUnisonVoices)),
+      m_detuneCents(std::max(detuneCents, 0.0f)),
+      m_spread(std::clamp(spread, 0.0f, 1.0f))
+{
+}
+
+void Unison::setVoices(uint32_t const voices)
+{
+    m_voiceCount.store(std::clamp(voices, 1u, c_maxUnisonVoices),
+                       std::memory_order_relaxed);
+}
+
+void Unison::setDetuneCents(float const cents)
+{
+    m_detuneCents.store(std::max(cents, 0.0f), std::memory_order_relaxed);
+}
+
+void Unison::setSpread(float const spread)
+{
+    m_spread.store(std::clamp(spread, 0.0f, 1.0f), std::memory_order_relaxed);
+}
+
+void Unison::noteOn() { m_retrigger.store(true, std::memory_order_relaxed); }
+
+uint32_t Unison::getVoices() const
+{
+    return m_voiceCount.load(std::memory_order_relaxed);
+}
+
+float Unison::getDetuneCents() const
+{
+    return m_detuneCents.load(std::memory_order_relaxed);
+}
+
+float Unison::getSpread() const
+{
+    return m_spread.load(std::memory_order_relaxed);
+}
+
+void Unison::updateLayout()
+{
+    uint32_t const voices = getVoices();
+    float const    detune = getDetuneCents();
+    float const    spread = getSpread();
+
+    if (voices == m_cachedVoices && detune == m_cachedDetune &&
+        spread == m_cachedSpread)
+        return;
+
+    m_cachedVoices = voices;
+    m_cachedDetune = detune;
+    m_cachedSpread = spread;
+    m_activeLanes =
+        (voices + simd::lanes - 1) & ~static_cast<uint32_t>(simd::lanes - 1);
+
+    // A single voice has unit gain; the stack keeps roughly the same
+    // loudness as voices are added
+    float const level = 1.0f / std::sqrt(static_cast<float>(voices));
+
+    for (uint32_t v = 0; v < c_maxUnisonVoices; ++v)
+    {
+        if (v >= voices)
+        {
+            m_ratios[v] = 0.0f;
+            m_gainL[v]  = 0.0f;
+            m_gainR[v]  = 0.0f;
+            continue;
+        }
+
+        // Position in the stack, -1 (flattest) to +1 (sharpest)
+        float const position =
+            voices == 1 ? 0.0f
+                        : 2.0f * static_cast<float>(v) /
+                                  static_cast<float>(voices - 1) -
+                              1.0f;
+
+        // Alternate sides so neighbouring detunes land in opposite channels
+        float const pan = spread * position * (v % 2 == 0 ? 1.0f : -1.0f);
+
+        // Balance law: the near side stays at unity and the far side fades
+        // out, so neither gain exceeds the voice level
+        float const halfPi = 0.5f * std::numbers::pi_v<float>;
+
+        m_ratios[v] = std::exp2(position * detune / 1200.0f);
+        m_gainL[v]  = std::cos(std::max(pan, 0.0f) * halfPi) * level;
+        m_gainR[v]  = std::cos(std::max(-pan, 0.0f) * halfPi) * level;
+    }
+}
+
+void Unison::randomizePhases()
+{
+    for (float &phase : m_phases)
+    {
+        // xorshift32
+        m_rngState ^= m_rngState << 13;
+        m_rngState ^= m_rngState >> 17;
+        m_rngState ^= m_rngState << 5;
+        phase = static_cast<float>(m_rngState >> 8) * 0x1.0p-24f;
+    }
+}
+
+void Unison::beginBlock()
+{
+    updateLayout();
+
+    if (m_retrigger.exchange(false, std::memory_order_relaxed) &&
+        m_cachedVoices > 1)
+        randomizePhases();
+}
@@ -1,6 +1,7 @@
 #include "../include/MidiNote.hpp"
 #include "../include/PortAudioStream.hpp"
 #include "../include/StreamState.hpp"
+#include "../include/Trace.hpp"
 #include "../include/constants.hpp"
 
 #include <array>
@@ -30,32 +31,14 @@ int main()
             PaStreamCallbackFlags           statusFlags,     //
             void                           *userData) -> int
     {
-        auto *out  = static_cast<float *>(outputBuffer);
-        auto *data = static_cast<StreamState *>(userData);
-
-        float const freq     = data->getCurrentFrequency();
-        float const phaseInc = freq / constants::audio::sample_rate;
-
-        for (unsigned long i = 0; i < framesPerBuffer; ++i)
-        {
-            size_t const idx =
-                c_tableMask &
-                static_cast<size_t>(data->getPhase() * c_tableSize);
-
-            float const oscillator = data->getWaveTable()[idx];
+        TRACE_SCOPE("callback");
+        TRACE_COUNTER("frames", framesPerBuffer);
 
-            // Apply envelope to the oscillator output
-            float const envelope = data->getEnvelope().processEnvelope();
-            float const sample   = oscillator * envelope;
-
-            *out++ = sample; // L
-            *out++ = sample; // R
+        auto *data = static_cast<StreamState *>(userData);
 
-            float ph = data->getPhase() + phaseInc;
-            if (ph >= 1.0f)
-                ph -= 1.0f;
-            data->setPhase(ph);
-        }
+        // Renders at the engine rate, resampling to the device rate and
+        // converting to the device sample format if needed
+        data->process(outputBuffer, framesPerBuffer);
 
         return paContinue;
     };
@@ -63,14 +46,20 @@ int main()
     PaStreamFinishedCallback *finished_cb =
         +[](void *userData) { std::cout << "Stream completed." << std::endl; };
 
+    // paInt16, paInt24 and paInt32 are converted and dithered by the engine
+    constexpr PaSampleFormat sample_format = paFloat32;
+
     PaStreamParameters output_parameters{.device           = paNoDevice,
                                          .channelCount     = 2,
-                                         .sampleFormat     = paFloat32,
+                                         .sampleFormat     = sample_format,
                                          .suggestedLatency = 0.0,
                                          .hostApiSpecificStreamInfo = nullptr};
 
     try
     {
+        // Writes a Chrome/Perfetto trace when built with tracing enabled
+        trace::Session const trace_session("hello-port-audio.trace.json");
+
         if (PaError const err = Pa_Initialize(); err != paNoError)
             throw std::runtime_error(Pa_GetErrorText(err));
 
@@ -78,9 +67,25 @@ int main()
         if (output_parameters.device == paNoDevice)
             throw std::runtime_error("No default output device.");
 
+        // Open the device at its native rate so the host API does not
+        // resample behind our back
+        PaDeviceInfo const *device_info =
+            Pa_GetDeviceInfo(output_parameters.device);
+        double const device_rate = device_info
+                                       ? device_info->defaultSampleRate
+                                       : constants::audio::sample_rate;
+
+        float const engine_rate = constants::audio::engine_sample_rate > 0.0f
+                                      ? constants::audio::engine_sample_rate
+                                      : static_cast<float>(device_rate);
+
+        stream_state.setSampleRate(engine_rate);
+        stream_state.setOutputSampleRate(static_cast<float>(device_rate));
+        stream_state.setOutputFormat(sample_format, DitherMode::NoiseShaped);
+
         // Create and run stream
-        PortAudioStream audio_stream({}, output_parameters, stream_cb,
-                                     &stream_state);
+        PortAudioStream audio_stream({}, output_parameters, device_rate,
+                                     stream_cb, &stream_state);
 
         audio_stream.setFinishedCallback(finished_cb);
         audio_stream.start();
@@ -93,18 +98,40 @@ int main()
 
             using U = std::underlying_type_t<MidiNote>;
 
-            Envelope &env = stream_state.getEnvelope();
+            Unison    &unison = stream_state.getUnison();
+            ModMatrix &matrix = stream_state.getModMatrix();
+
+            // Seven-voice supersaw, detuned +/- 18 cents and spread wide
+            stream_state.setWaveform(Waveform::Saw);
+            unison.setVoices(7);
+            unison.setDetuneCents(18.0f);
+            unison.setSpread(0.8f);
+
+            // Summed detuned saws peak well above a single voice; leave
+            // headroom so the integer output never clips
+            stream_state.setOutputGain(0.5f);
+
+            // Envelope-swept filter, gentle vibrato and auto-pan
+            stream_state.getFilter().setEnabled(true);
+            stream_state.getFilter().setCutoffHz(800.0f);
+            stream_state.getModEnvelope().setReleaseMs(150);
+            stream_state.getLfo(0).setRateHz(5.5f);
+            stream_state.getLfo(1).setRateHz(0.5f);
+
+            matrix.setRoute(0, ModSource::Envelope, ModDestination::Cutoff,
+                            3.0f);
+            matrix.setRoute(1, ModSource::Lfo1, ModDestination::Pitch, 0.15f);
+            matrix.setRoute(2, ModSource::Lfo2, ModDestination::Pan, 0.5f);
 
             constexpr auto upper = MidiNote::A2;
             constexpr auto lower = MidiNote::A7;
 
             auto play_note = [&](MidiNote const n) -> void
             {
-                stream_state.setFrequency(midi_to_frequency(n));
-                env.noteOn(); // Trigger envelope
+                stream_state.noteOn(n, 0.8f); // Trigger envelopes
                 Pa_Sleep(note_duration);
-                env.noteOff();      // Release envelope
-                Pa_Sleep(note_gap); // Wait for release to complete
+                stream_state.noteOff(); // Release envelopes
+                Pa_Sleep(note_gap);     // Wait for release to complete
             };
             // Ascending
             for (auto note = upper; note < lower;